@@ -0,0 +1,196 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AtomicSharedPtr.hpp"
+#include "Benchmark.hpp"
+
+// 模拟配置快照: 每个请求读一次, 偶尔整体换掉
+struct Config {
+    static inline std::atomic<long> live{0};
+
+    uint64_t m_version;
+    std::string m_host;
+
+    explicit Config(uint64_t version) : m_version(version), m_host("example.org") {
+        live.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~Config() {
+        live.fetch_sub(1, std::memory_order_relaxed);
+    }
+};
+
+void test_ours() {
+    {
+        AtomicSharedPtr<Config> config(makeShared<Config>(1));
+        SharedPtr<Config> snapshot = config.load();
+        printf("load: version = %lu, use_count = %ld\n", (unsigned long)snapshot->m_version, snapshot.use_count());
+        SharedPtr<Config> old = config.exchange(makeShared<Config>(2));
+        printf("exchange: old = %lu, new = %lu\n", (unsigned long)old->m_version, (unsigned long)config.load()->m_version);
+
+        // expected不是当前值: 失败, 并把expected更新为当前值
+        SharedPtr<Config> expected = old;
+        bool ok = config.compare_exchange_strong(expected, makeShared<Config>(3));
+        printf("cas with stale expected: %d, expected now = %lu\n", ok, (unsigned long)expected->m_version);
+        ok = config.compare_exchange_strong(expected, makeShared<Config>(3));
+        printf("cas with current expected: %d, now = %lu\n", ok, (unsigned long)config.load()->m_version);
+
+        config.store(nullptr);
+        SharedPtr<Config> empty;
+        bool was_empty = config.load() == nullptr;
+        ok = config.compare_exchange_strong(empty, makeShared<Config>(4));
+        printf("after store(nullptr): empty = %d, cas(null -> 4) = %d\n", was_empty, ok);
+    }
+    printf("live configs after scope: %ld\n", Config::live.load());
+
+    // 多个线程边读边换, 最后所有快照都应该被释放
+    {
+        AtomicSharedPtr<Config> config(makeShared<Config>(0));
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> sum{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 3; t++) {
+            threads.emplace_back([&] {
+                uint64_t local = 0;
+                while (!stop.load(std::memory_order_relaxed))
+                    local += config.load()->m_version;
+                sum.fetch_add(local, std::memory_order_relaxed);
+            });
+        }
+        for (uint64_t v = 1; v <= 2000; v++) {
+            if (v % 2)
+                config.store(makeShared<Config>(v));
+            else {
+                SharedPtr<Config> expected = config.load();
+                config.compare_exchange_strong(expected, makeShared<Config>(v));
+            }
+        }
+        stop.store(true, std::memory_order_relaxed);
+        for (auto &t: threads)
+            t.join();
+        printf("stress: final version = %lu, live = %ld\n", (unsigned long)config.load()->m_version, Config::live.load());
+    }
+    printf("live configs after stress: %ld\n", Config::live.load());
+
+    // 写者在有值和空值之间来回切换, 读者同时load: 空值也是独立的Node, 外部计数不会串到下一个空值上
+    {
+        AtomicSharedPtr<Config> config;
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> empties{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 3; t++) {
+            threads.emplace_back([&] {
+                uint64_t local = 0;
+                while (!stop.load(std::memory_order_relaxed))
+                    local += config.load() == nullptr;
+                empties.fetch_add(local, std::memory_order_relaxed);
+            });
+        }
+        for (uint64_t v = 1; v <= 20000; v++) {
+            config.store(makeShared<Config>(v));
+            config.store(nullptr);
+        }
+        stop.store(true, std::memory_order_relaxed);
+        for (auto &t: threads)
+            t.join();
+        printf("null stress: final empty = %d, live = %ld\n", config.load() == nullptr, Config::live.load());
+        doNotOptimize(empties.load());
+    }
+    printf("live configs after null stress: %ld\n", Config::live.load());
+}
+
+// 三种发布方式包成同样的接口, 方便一起测
+struct OursBox {
+    AtomicSharedPtr<Config> m_ptr{makeShared<Config>(0)};
+
+    uint64_t read() const {
+        return m_ptr.load()->m_version;
+    }
+
+    void publish(uint64_t version) {
+        m_ptr.store(makeShared<Config>(version));
+    }
+};
+
+struct StdAtomicBox {
+    std::atomic<std::shared_ptr<Config>> m_ptr{std::make_shared<Config>(0)};
+
+    uint64_t read() const {
+        return m_ptr.load()->m_version;
+    }
+
+    void publish(uint64_t version) {
+        m_ptr.store(std::make_shared<Config>(version));
+    }
+};
+
+struct MutexBox {
+    mutable std::mutex m_mutex;
+    std::shared_ptr<Config> m_ptr = std::make_shared<Config>(0);
+
+    uint64_t read() const {
+        std::shared_ptr<Config> snapshot;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            snapshot = m_ptr;
+        }
+        return snapshot->m_version;
+    }
+
+    void publish(uint64_t version) {
+        auto fresh = std::make_shared<Config>(version);
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_ptr.swap(fresh);
+    }
+};
+
+// readers个线程各读n次, 同时有一个写线程每隔一毫秒换一次快照
+// 报告的是总耗时除以总读取次数, 能多核并行时这个数应该随线程数下降
+template <class Box>
+void bench_readers(char const *name, int readers, size_t n) {
+    Box box;
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> sum{0};
+    char label[64];
+    snprintf(label, sizeof label, "%s, %d readers", name, readers);
+    benchmark(label, [&] {
+        std::thread writer([&] {
+            for (uint64_t v = 1; !stop.load(std::memory_order_relaxed); v++) {
+                box.publish(v);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+        std::vector<std::thread> threads;
+        for (int t = 0; t < readers; t++) {
+            threads.emplace_back([&] {
+                uint64_t local = 0;
+                for (size_t i = 0; i < n; i++)
+                    local += box.read();
+                sum.fetch_add(local, std::memory_order_relaxed);
+            });
+        }
+        for (auto &t: threads)
+            t.join();
+        stop.store(true, std::memory_order_relaxed);
+        writer.join();
+    }, n * readers);
+    doNotOptimize(sum.load());
+}
+
+int main() {
+    test_ours();
+    size_t n = 1 << 21;
+    printf("== read-mostly snapshot, %u hardware threads ==\n", std::thread::hardware_concurrency());
+    for (int readers: {1, 2, 4}) {
+        bench_readers<OursBox>("AtomicSharedPtr", readers, n);
+        bench_readers<StdAtomicBox>("std::atomic<shared_ptr>", readers, n);
+        bench_readers<MutexBox>("mutex + shared_ptr", readers, n);
+    }
+    return 0;
+}
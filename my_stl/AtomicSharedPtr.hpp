@@ -0,0 +1,185 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include "SharedPtr.hpp"
+
+// 可以被多个线程同时load/store的SharedPtr, 全部操作无锁
+// 典型用法是读多写少的共享状态: 每个请求load一份配置快照, 偶尔整体换掉
+//
+// 用分离引用计数(split reference count)解决"读到指针之后、加计数之前, 对象被别人释放"的问题:
+// 原子变量里存的是一个Node*, 高16位借来做"外部计数", 表示正在读这个Node的线程数
+// load先用一次fetch_add把外部计数加1, 同时拿到指针, 这之后Node不会被释放;
+// 拷贝出Node里的SharedPtr后再把外部计数减回去
+// store把原子变量整个换掉, 旧Node上还没减回去的外部计数转进Node自己的m_count,
+// 那些读者发现指针已经变了, 就改为减m_count, 最后一个把它减到0的释放Node
+//
+// 假设用户态地址只用低48位(x86-64和AArch64的常见配置), 同一时刻最多65535个线程在load同一个变量
+// 两个假设都在运行时检查, 不满足时abort而不是悄悄算错: 带标签的指针(AArch64的TBI/MTE, HWASan)
+// 或者5级页表(LA57)下高于48位的地址, 以及外部计数溢出
+// 不提供memory_order参数, 所有操作都至少有acquire/release语义
+template <class T>
+struct AtomicSharedPtr {
+private:
+    static_assert(sizeof(void *) == 8, "AtomicSharedPtr packs a count into the pointer's high bits");
+
+    // 每次store分配一个Node, 包着要发布的SharedPtr; 空的SharedPtr也分配一个Node, 原子变量里从不存空指针:
+    // 读者持有外部计数期间, 它加计数的那个地址在所有读者离开前都不能被别的值重新使用,
+    // 堆上的Node满足这一点, nullptr不满足(store(x)再store(nullptr)之后又是同一个字, 晚走的读者会减错计数)
+    struct Node {
+        SharedPtr<T> m_value;
+        // 转进来的外部计数减去已经离开的读者数, 两边相抵为0时释放
+        std::atomic<long> m_count{0};
+
+        explicit Node(SharedPtr<T> value) noexcept : m_value(std::move(value)) {}
+    };
+
+    static constexpr int kCountShift = 48;
+    static constexpr uint64_t kOne = uint64_t(1) << kCountShift;
+    static constexpr uint64_t kPtrMask = kOne - 1;
+    static constexpr long kMaxReaders = long(~uint64_t(0) >> kCountShift);
+
+    // load在逻辑上只读, 但要改外部计数
+    mutable std::atomic<uint64_t> m_word{0};
+
+    static Node *node_of(uint64_t word) noexcept {
+        return reinterpret_cast<Node *>(word & kPtrMask);
+    }
+
+    static long count_of(uint64_t word) noexcept {
+        return long(word >> kCountShift);
+    }
+
+    static uint64_t pack(Node *node) noexcept {
+        return reinterpret_cast<uint64_t>(node);
+    }
+
+    static Node *make_node(SharedPtr<T> value) {
+        Node *node = new Node(std::move(value));
+        // 高16位要留给外部计数, 地址超出48位或者带了标签就没法打包
+        if ((reinterpret_cast<uint64_t>(node) & ~kPtrMask) != 0) [[unlikely]]
+            std::abort();
+        return node;
+    }
+
+    // 和std::atomic<shared_ptr>一样, 指针相同且共享同一个控制块才算相等
+    static bool same(Node *node, SharedPtr<T> const &p) noexcept {
+        return node->m_value == p && node->m_value.owner_equal(p);
+    }
+
+    // 外部计数加1, 返回加完之后的值; 之后直到release_ref前都可以安全访问node
+    // 加之前已经是kMaxReaders说明计数进位溢出了, 指针还对但计数已经错了, 只能abort
+    uint64_t acquire_ref() const noexcept {
+        uint64_t old = m_word.fetch_add(kOne, std::memory_order_acquire);
+        if (count_of(old) == kMaxReaders) [[unlikely]]
+            std::abort();
+        return old + kOne;
+    }
+
+    // 指针还没变: 直接把外部计数减回去; 已经被换掉: 自己的那份计数已经转进了m_count, 改减它
+    void release_ref(Node *node) const noexcept {
+        uint64_t cur = m_word.load(std::memory_order_relaxed);
+        while (node_of(cur) == node) {
+            if (m_word.compare_exchange_weak(cur, cur - kOne, std::memory_order_release, std::memory_order_relaxed))
+                return;
+        }
+        retire(node, -1);
+    }
+
+    // 把delta加到m_count上: 换下Node的人转入外部计数, 晚走的读者各减1, 总和回到0时释放
+    // 转入之前m_count只会是负数, 转入之后单调减到0, 所以只有最后一个人会看到0
+    static void retire(Node *node, long delta) noexcept {
+        if (node->m_count.fetch_add(delta, std::memory_order_acq_rel) + delta == 0)
+            delete node;
+    }
+
+    // 换下来的Node: 外部计数全部转进m_count
+    static void detach(uint64_t old) noexcept {
+        retire(node_of(old), count_of(old));
+    }
+
+public:
+    // 空值也要分配一个Node, 所以默认构造可能抛出bad_alloc
+    AtomicSharedPtr() : AtomicSharedPtr(SharedPtr<T>()) {}
+
+    AtomicSharedPtr(SharedPtr<T> value) : m_word(pack(make_node(std::move(value)))) {}
+
+    AtomicSharedPtr(AtomicSharedPtr const &) = delete;
+    AtomicSharedPtr &operator=(AtomicSharedPtr const &) = delete;
+
+    // 析构时不能再有其他线程在访问, 外部计数必然为0
+    ~AtomicSharedPtr() {
+        detach(m_word.load(std::memory_order_acquire));
+    }
+
+    static constexpr bool is_always_lock_free = true;
+
+    bool is_lock_free() const noexcept {
+        return true;
+    }
+
+    SharedPtr<T> load() const noexcept {
+        Node *node = node_of(acquire_ref());
+        SharedPtr<T> result = node->m_value;
+        release_ref(node);
+        return result;
+    }
+
+    operator SharedPtr<T>() const noexcept {
+        return load();
+    }
+
+    SharedPtr<T> exchange(SharedPtr<T> desired) {
+        Node *fresh = make_node(std::move(desired));
+        uint64_t old = m_word.exchange(pack(fresh), std::memory_order_acq_rel);
+        // 可能还有读者正在拷贝m_value, 只能拷贝出来, 不能move
+        SharedPtr<T> result = node_of(old)->m_value;
+        detach(old);
+        return result;
+    }
+
+    void store(SharedPtr<T> desired) {
+        Node *fresh = make_node(std::move(desired));
+        detach(m_word.exchange(pack(fresh), std::memory_order_acq_rel));
+    }
+
+    AtomicSharedPtr &operator=(SharedPtr<T> desired) {
+        store(std::move(desired));
+        return *this;
+    }
+
+    // 失败时expected被更新为当前值, 同std::atomic
+    // 先持有当前Node再比较, 比较通过后用CAS换掉整个字; 期间有其他读者改了外部计数就重试
+    bool compare_exchange_strong(SharedPtr<T> &expected, SharedPtr<T> desired) {
+        Node *fresh = nullptr;
+        bool allocated = false;
+        for (;;) {
+            uint64_t cur = acquire_ref();
+            Node *node = node_of(cur);
+            if (!same(node, expected)) {
+                expected = node->m_value;
+                release_ref(node);
+                delete fresh;
+                return false;
+            }
+            if (!allocated) {
+                // 只在第一次比较通过后分配, 比较失败的常见情况不用分配
+                fresh = make_node(std::move(desired));
+                allocated = true;
+            }
+            if (m_word.compare_exchange_strong(cur, pack(fresh), std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                // 转入的外部计数里包括自己的那一份, 顺便减掉
+                retire(node, count_of(cur) - 1);
+                return true;
+            }
+            release_ref(node);
+        }
+    }
+
+    // 没有伪失败, 和strong相同
+    bool compare_exchange_weak(SharedPtr<T> &expected, SharedPtr<T> desired) {
+        return compare_exchange_strong(expected, std::move(desired));
+    }
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+// 各个demo共用的简易计时工具, 不依赖google benchmark
+
+// 防止编译器把被测代码的结果优化掉
+template <class T>
+inline void doNotOptimize(T const &value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile T const *sink;
+    sink = &value;
+#endif
+}
+
+// 运行一次f并打印耗时, ops不为0时同时打印每次操作的纳秒数
+template <class F>
+double benchmark(char const *name, F &&f, size_t ops = 0) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+    if (ops != 0)
+        printf("%-40s %10.3f ms %8.2f ns/op\n", name, ns / 1e6, ns / ops);
+    else
+        printf("%-40s %10.3f ms\n", name, ns / 1e6);
+    return ns;
+}
@@ -0,0 +1,157 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Benchmark.hpp"
+#include "ChaseLevDeque.hpp"
+#include "Deque.hpp"
+
+void test_ours() {
+    ChaseLevDeque<int> dq(4);
+    for (int i = 1; i <= 10; i++)
+        dq.push(i);
+    printf("size = %zd, capacity = %zd\n", dq.size(), dq.capacity());
+    printf("steal = %d, pop = %d\n", *dq.steal(), *dq.pop());
+    while (auto x = dq.pop())
+        printf("%d ", *x);
+    printf("\npop on empty: %d, steal on empty: %d\n", dq.pop().has_value(), dq.steal().has_value());
+}
+
+// owner边push边pop, thief不停地偷; 每个元素必须恰好被取出一次
+void test_stress(size_t nthieves, uint32_t n) {
+    ChaseLevDeque<uint32_t> dq(2);
+    std::vector<std::atomic<uint8_t>> seen(n);
+    std::atomic<bool> done{false};
+    std::atomic<size_t> stolen{0};
+    std::vector<std::thread> thieves;
+    for (size_t t = 0; t < nthieves; t++) {
+        thieves.emplace_back([&] {
+            size_t count = 0;
+            while (!done.load(std::memory_order_acquire) || !dq.empty()) {
+                if (auto x = dq.steal()) {
+                    seen[*x].fetch_add(1, std::memory_order_relaxed);
+                    ++count;
+                }
+            }
+            stolen.fetch_add(count);
+        });
+    }
+    size_t popped = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        dq.push(i);
+        // 每push三个pop一个, 队列长度在涨, 会触发扩容
+        if (i % 3 == 0) {
+            if (auto x = dq.pop()) {
+                seen[*x].fetch_add(1, std::memory_order_relaxed);
+                ++popped;
+            }
+        }
+    }
+    while (auto x = dq.pop()) {
+        seen[*x].fetch_add(1, std::memory_order_relaxed);
+        ++popped;
+    }
+    done.store(true, std::memory_order_release);
+    for (auto &th: thieves)
+        th.join();
+    size_t bad = 0;
+    for (auto &s: seen)
+        bad += s.load() != 1;
+    printf("stress: %zd thieves, popped = %zd, stolen = %zd, lost or duplicated = %zd\n",
+           nthieves, popped, stolen.load(), bad);
+}
+
+// 对照组: 一把锁保护的Deque
+struct LockedDeque {
+    std::mutex m_mutex;
+    Deque<uint32_t> m_deque;
+
+    void push(uint32_t value) {
+        std::lock_guard lock(m_mutex);
+        m_deque.push_back(value);
+    }
+
+    Optional<uint32_t> pop() {
+        std::lock_guard lock(m_mutex);
+        if (m_deque.empty())
+            return Nullopt;
+        uint32_t value = m_deque.back();
+        m_deque.pop_back();
+        return value;
+    }
+
+    Optional<uint32_t> steal() {
+        std::lock_guard lock(m_mutex);
+        if (m_deque.empty())
+            return Nullopt;
+        uint32_t value = m_deque.front();
+        m_deque.pop_front();
+        return value;
+    }
+};
+
+// 模拟一个很小的任务
+inline uint64_t work(uint32_t x) {
+    uint64_t h = x;
+    for (int i = 0; i < 16; i++)
+        h = h * 0x9e3779b97f4a7c15ULL + i;
+    return h;
+}
+
+// owner按批push再pop自己的任务, nthieves个线程同时偷; 统计全部任务做完的吞吐
+template <class Q>
+void bench_owner_vs_thieves(char const *name, size_t nthieves, uint32_t n) {
+    Q q;
+    std::atomic<uint32_t> remaining{n};
+    char label[96];
+    snprintf(label, sizeof label, "%s 1 owner + %zd thieves", name, nthieves);
+    benchmark(label, [&] {
+        std::vector<std::thread> thieves;
+        for (size_t t = 0; t < nthieves; t++) {
+            thieves.emplace_back([&] {
+                uint64_t sum = 0;
+                while (remaining.load(std::memory_order_relaxed) != 0) {
+                    if (auto x = q.steal()) {
+                        sum += work(*x);
+                        remaining.fetch_sub(1, std::memory_order_relaxed);
+                    }
+                }
+                doNotOptimize(sum);
+            });
+        }
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < n; i += 64) {
+            for (uint32_t j = i; j < i + 64 && j < n; j++)
+                q.push(j);
+            for (int k = 0; k < 48; k++) {
+                if (auto x = q.pop()) {
+                    sum += work(*x);
+                    remaining.fetch_sub(1, std::memory_order_relaxed);
+                }
+            }
+        }
+        while (auto x = q.pop()) {
+            sum += work(*x);
+            remaining.fetch_sub(1, std::memory_order_relaxed);
+        }
+        while (remaining.load(std::memory_order_relaxed) != 0)
+            std::this_thread::yield();
+        doNotOptimize(sum);
+        for (auto &th: thieves)
+            th.join();
+    }, n);
+}
+
+int main() {
+    test_ours();
+    for (size_t nthieves: {1, 3, 7})
+        test_stress(nthieves, 1000000);
+    uint32_t n = 2000000;
+    for (size_t nthieves: {0, 1, 3, 7}) {
+        bench_owner_vs_thieves<ChaseLevDeque<uint32_t>>("ChaseLevDeque", nthieves, n);
+        bench_owner_vs_thieves<LockedDeque>("Deque + mutex", nthieves, n);
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include "Optional.hpp"
+
+// Chase-Lev工作窃取双端队列: 只有一个owner线程在底部push/pop, 任意多个thief线程从顶部steal
+// owner的push/pop在没有竞争时不需要CAS, 只有抢最后一个元素时和thief用CAS在top上决胜负
+// 内存序按Lê等人的论文(Correct and Efficient Work-Stealing for Weak Memory Models, PPoPP'13)
+// 元素存在atomic<T>里, 所以T必须可平凡拷贝, 一般放任务指针
+template <class T>
+struct ChaseLevDeque {
+    static_assert(std::is_trivially_copyable_v<T>, "ChaseLevDeque stores T in std::atomic<T>");
+
+private:
+    // 环形数组, 下标对容量取模; 扩容后旧数组挂在m_prev上, 可能还有thief在读, 析构时统一释放
+    struct Array {
+        int64_t m_mask;
+        Array *m_prev;
+        std::atomic<T> m_slots[1];
+
+        static Array *create(int64_t capacity, Array *prev) {
+            void *p = ::operator new(sizeof(Array) + (capacity - 1) * sizeof(std::atomic<T>));
+            Array *a = ::new (p) Array;
+            a->m_mask = capacity - 1;
+            a->m_prev = prev;
+            for (int64_t i = 1; i < capacity; i++)
+                ::new (&a->m_slots[i]) std::atomic<T>;
+            return a;
+        }
+
+        int64_t capacity() const noexcept {
+            return m_mask + 1;
+        }
+
+        T get(int64_t i) const noexcept {
+            return m_slots[i & m_mask].load(std::memory_order_relaxed);
+        }
+
+        void put(int64_t i, T value) noexcept {
+            m_slots[i & m_mask].store(value, std::memory_order_relaxed);
+        }
+
+        // 只有owner会调用, [top, bottom)之间的元素搬到两倍大的新数组, 下标不变
+        Array *grow(int64_t top, int64_t bottom) {
+            Array *a = create(capacity() * 2, this);
+            for (int64_t i = top; i != bottom; i++)
+                a->put(i, get(i));
+            return a;
+        }
+    };
+
+    // top被thief频繁CAS, bottom只有owner写, 分开放在不同的缓存行
+    alignas(64) std::atomic<int64_t> m_top;
+    alignas(64) std::atomic<int64_t> m_bottom;
+    std::atomic<Array *> m_array;
+
+public:
+    explicit ChaseLevDeque(size_t capacity = 64) : m_top(0), m_bottom(0) {
+        size_t cap = 2;
+        while (cap < capacity)
+            cap *= 2;
+        m_array.store(Array::create((int64_t)cap, nullptr), std::memory_order_relaxed);
+    }
+
+    ChaseLevDeque(ChaseLevDeque const &) = delete;
+    ChaseLevDeque &operator=(ChaseLevDeque const &) = delete;
+
+    ~ChaseLevDeque() noexcept {
+        Array *a = m_array.load(std::memory_order_relaxed);
+        while (a != nullptr) {
+            Array *prev = a->m_prev;
+            ::operator delete(a);
+            a = prev;
+        }
+    }
+
+    // 只能由owner调用
+    void push(T value) {
+        int64_t b = m_bottom.load(std::memory_order_relaxed);
+        int64_t t = m_top.load(std::memory_order_acquire);
+        Array *a = m_array.load(std::memory_order_relaxed);
+        if (b - t > a->m_mask) [[unlikely]] {
+            a = a->grow(t, b);
+            m_array.store(a, std::memory_order_release);
+        }
+        a->put(b, value);
+        // 元素写入要先于bottom的更新被thief看到; 用release store而不是fence + relaxed store,
+        // x86上一样是普通mov, ARM上是stlr, 而且TSAN能认出这一对release/acquire
+        m_bottom.store(b + 1, std::memory_order_release);
+    }
+
+    // 只能由owner调用, 取最后push的元素(LIFO)
+    Optional<T> pop() noexcept {
+        int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+        Array *a = m_array.load(std::memory_order_relaxed);
+        m_bottom.store(b, std::memory_order_relaxed);
+        // 先公布bottom-1再读top, 与steal里的fence配对, 保证双方至少有一个看到对方
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = m_top.load(std::memory_order_relaxed);
+        if (t > b) {
+            // 本来就是空的
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return Nullopt;
+        }
+        T value = a->get(b);
+        if (t == b) {
+            // 只剩最后一个, 和thief抢
+            bool won = m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            if (!won)
+                return Nullopt;
+        }
+        return value;
+    }
+
+    // 任意线程都能调用, 取最早push的元素(FIFO)
+    // 返回空可能是队列空, 也可能是CAS输给了别的thief或owner, 调用者可以重试或换一个队列偷
+    Optional<T> steal() noexcept {
+        int64_t t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = m_bottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return Nullopt;
+        // 论文里是consume, 编译器都把consume当acquire处理
+        Array *a = m_array.load(std::memory_order_acquire);
+        T value = a->get(t);
+        if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return Nullopt;
+        return value;
+    }
+
+    // 并发时只是一个近似值
+    size_t size() const noexcept {
+        int64_t b = m_bottom.load(std::memory_order_relaxed);
+        int64_t t = m_top.load(std::memory_order_relaxed);
+        return b > t ? (size_t)(b - t) : 0;
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    size_t capacity() const noexcept {
+        return (size_t)m_array.load(std::memory_order_relaxed)->capacity();
+    }
+};
@@ -0,0 +1,86 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Benchmark.hpp"
+#include "CompactOptional.hpp"
+
+static_assert(sizeof(CompactOptional<double>) == sizeof(double));
+static_assert(sizeof(CompactOptional<int *>) == sizeof(int *));
+static_assert(sizeof(CompactOptional<uint32_t>) == sizeof(uint32_t));
+static_assert(std::is_trivially_copyable_v<CompactOptional<double>>);
+
+void test_ours() {
+    CompactOptional<double> d;
+    printf("empty: has_value = %d, value_or = %g\n", d.has_value(), d.value_or(-1.0));
+    d = std::nan("");
+    printf("computed NaN is a value: has_value = %d\n", d.has_value());
+    d = 3.5;
+    printf("3.5: has_value = %d, *d = %g\n", d.has_value(), *d);
+    d.reset();
+    try {
+        d.value();
+    } catch (BadOptionalAccess const &e) {
+        printf("reset: %s\n", e.what());
+    }
+
+    int x = 42;
+    CompactOptional<int *> p(&x);
+    printf("pointer: has_value = %d, **p = %d, == Nullopt: %d\n", p.has_value(), **p, p == Nullopt);
+
+    CompactOptional<int, SentinelNiche<int, -1>> idx;
+    printf("sentinel -1: has_value = %d, sizeof = %zd\n", idx.has_value(), sizeof(idx));
+    idx = 0;
+    Optional<int> opt = idx.to_optional();
+    printf("to_optional: has_value = %d, value = %d\n", opt.has_value(), opt.value());
+}
+
+// 每种数组扫一遍, 把存在的值加起来
+template <class Opt>
+void bench_scan(char const *name, std::vector<Opt> const &arr) {
+    char label[96];
+    snprintf(label, sizeof label, "%s (%zd B/elem)", name, sizeof(Opt));
+    benchmark(label, [&] {
+        double sum = 0;
+        size_t present = 0;
+        for (auto const &opt: arr) {
+            if (opt.has_value()) {
+                sum += *opt;
+                ++present;
+            }
+        }
+        doNotOptimize(sum);
+        doNotOptimize(present);
+    }, arr.size());
+}
+
+template <class T, class Gen>
+void bench_type(char const *title, size_t n, Gen gen) {
+    printf("== scan %s, %zd elements, 20%% empty ==\n", title, n);
+    std::mt19937 rng(42);
+    std::vector<Optional<T>> wide;
+    std::vector<CompactOptional<T>> compact;
+    wide.reserve(n);
+    compact.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        if (rng() % 5 == 0) {
+            wide.emplace_back(Nullopt);
+            compact.emplace_back(Nullopt);
+        } else {
+            T value = gen(i);
+            wide.emplace_back(value);
+            compact.emplace_back(value);
+        }
+    }
+    bench_scan("Optional", wide);
+    bench_scan("CompactOptional", compact);
+}
+
+int main() {
+    test_ours();
+    size_t n = 1 << 24;
+    bench_type<double>("double", n, [] (size_t i) { return (double)i * 0.5; });
+    bench_type<uint32_t>("uint32_t", n, [] (size_t i) { return (uint32_t)i; });
+    return 0;
+}
@@ -0,0 +1,170 @@
+#pragma once
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include "Optional.hpp"
+
+// 空值特征(niche): 从T的取值里挑一个永远不会用到的位模式表示"没有值"
+// 需要提供 static T empty_value() 和 static bool is_empty(T const &)
+// 没有特化的类型不能用CompactOptional, 请用Optional或者自己写一个特征
+template <class T>
+struct OptionalNiche;
+
+// 指针: nullptr
+template <class T>
+struct OptionalNiche<T *> {
+    static constexpr T *empty_value() noexcept {
+        return nullptr;
+    }
+
+    static constexpr bool is_empty(T *p) noexcept {
+        return p == nullptr;
+    }
+};
+
+// 整数: 最大值
+template <class T> requires std::is_integral_v<T> && (!std::is_same_v<T, bool>)
+struct OptionalNiche<T> {
+    static constexpr T empty_value() noexcept {
+        return std::numeric_limits<T>::max();
+    }
+
+    static constexpr bool is_empty(T x) noexcept {
+        return x == std::numeric_limits<T>::max();
+    }
+};
+
+// 浮点: 一个特定payload的quiet NaN, 按位比较
+// 计算产生的NaN(payload为0)依然可以作为值存进来
+template <class T> requires std::is_floating_point_v<T> && std::numeric_limits<T>::is_iec559
+struct OptionalNiche<T> {
+    using Bits = std::conditional_t<sizeof(T) == 8, uint64_t, uint32_t>;
+    static_assert(sizeof(T) == sizeof(Bits), "only float and double are supported");
+
+    static constexpr Bits kBits = sizeof(T) == 8 ? Bits(0x7ff8'0000'dead'beefULL) : Bits(0x7fc0'beefU);
+
+    static constexpr T empty_value() noexcept {
+        return std::bit_cast<T>(kBits);
+    }
+
+    static constexpr bool is_empty(T x) noexcept {
+        return std::bit_cast<Bits>(x) == kBits;
+    }
+};
+
+// 用户指定哨兵值, 如 CompactOptional<int, SentinelNiche<int, -1>>
+template <class T, T Sentinel>
+struct SentinelNiche {
+    static constexpr T empty_value() noexcept {
+        return Sentinel;
+    }
+
+    static constexpr bool is_empty(T const &x) noexcept {
+        return x == Sentinel;
+    }
+};
+
+// 把"空"编码在T自己的取值里的Optional: 没有额外的bool, sizeof和T一样
+// CompactOptional<T>的数组与T的数组一样紧凑; 代价是哨兵值本身不能存进来
+// 只支持可平凡拷贝的T, 空的时候m_value里放的就是哨兵值
+template <class T, class Niche = OptionalNiche<T>>
+struct CompactOptional {
+    static_assert(std::is_trivially_copyable_v<T>, "CompactOptional stores the sentinel in T itself");
+
+    constexpr CompactOptional() noexcept : m_value(Niche::empty_value()) {}
+
+    constexpr CompactOptional(Nullopt_t) noexcept : m_value(Niche::empty_value()) {}
+
+    constexpr CompactOptional(T value) noexcept : m_value(value) {
+        assert(!Niche::is_empty(m_value) && "value collides with the CompactOptional sentinel");
+    }
+
+    constexpr CompactOptional(Optional<T> const &opt) noexcept
+    : m_value(opt.has_value() ? *opt : Niche::empty_value()) {}
+
+    // 拷贝/移动/析构全部平凡, 与T一样可以memcpy
+
+    constexpr CompactOptional &operator=(Nullopt_t) noexcept {
+        m_value = Niche::empty_value();
+        return *this;
+    }
+
+    constexpr CompactOptional &operator=(T value) noexcept {
+        assert(!Niche::is_empty(value) && "value collides with the CompactOptional sentinel");
+        m_value = value;
+        return *this;
+    }
+
+    constexpr bool has_value() const noexcept {
+        return !Niche::is_empty(m_value);
+    }
+
+    constexpr explicit operator bool() const noexcept {
+        return has_value();
+    }
+
+    constexpr T value() const {
+        if (!has_value())
+            throw BadOptionalAccess();
+        return m_value;
+    }
+
+    constexpr T const &operator*() const noexcept {
+        return m_value;
+    }
+
+    constexpr T &operator*() noexcept {
+        return m_value;
+    }
+
+    constexpr T const *operator->() const noexcept {
+        return &m_value;
+    }
+
+    constexpr T *operator->() noexcept {
+        return &m_value;
+    }
+
+    constexpr T value_or(T default_value) const noexcept {
+        return has_value() ? m_value : default_value;
+    }
+
+    constexpr void emplace(T value) noexcept {
+        *this = value;
+    }
+
+    constexpr void reset() noexcept {
+        m_value = Niche::empty_value();
+    }
+
+    constexpr void swap(CompactOptional &other) noexcept {
+        std::swap(m_value, other.m_value);
+    }
+
+    Optional<T> to_optional() const {
+        if (!has_value())
+            return Nullopt;
+        return Optional<T>(m_value);
+    }
+
+    constexpr bool operator==(Nullopt_t) const noexcept {
+        return !has_value();
+    }
+
+    constexpr bool operator==(CompactOptional const &other) const noexcept {
+        if (has_value() != other.has_value())
+            return false;
+        return !has_value() || m_value == other.m_value;
+    }
+
+private:
+    T m_value;
+};
+
+template <class T>
+constexpr CompactOptional<T> makeCompactOptional(T value) noexcept {
+    return CompactOptional<T>(value);
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+
+// 侵入式容器共用: 从内嵌钩子的地址反推出外层对象, 同Linux内核的container_of
+// 以前的写法是拿一个假的T指针去取&(obj->*member), 那个地址上并没有T对象, 是未定义行为
+// 这里直接读成员指针本身: Itanium C++ ABI(GCC/Clang在Linux/macOS上)规定数据成员指针
+// 就是成员相对对象起始地址的字节偏移, 和ptrdiff_t一样大; 不满足这个ABI的平台编译时报错
+template <class T, class M>
+inline ptrdiff_t member_offset(M T::*member) noexcept {
+    static_assert(sizeof(member) == sizeof(ptrdiff_t), "member_offset assumes the Itanium C++ ABI");
+    return std::bit_cast<ptrdiff_t>(member);
+}
+
+template <class T, class M>
+inline T *container_of(M *hook, M T::*member) noexcept {
+    return reinterpret_cast<T *>(reinterpret_cast<char *>(hook) - member_offset(member));
+}
+
+template <class T, class M>
+inline T const *container_of(M const *hook, M T::*member) noexcept {
+    return reinterpret_cast<T const *>(reinterpret_cast<char const *>(hook) - member_offset(member));
+}
@@ -0,0 +1,134 @@
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <vector>
+#include "Benchmark.hpp"
+#include "Deque.hpp"
+
+static_assert(std::random_access_iterator<Deque<int>::iterator>);
+static_assert(std::random_access_iterator<Deque<int>::const_iterator>);
+
+void test_ours() {
+    Deque<int, 4> arr{3, 4, 5};
+    for (int i = 2; i >= 0; i--)
+        arr.push_front(i);
+    for (int i = 6; i < 10; i++)
+        arr.push_back(i);
+    // 头尾push只加块, 已有元素的地址不变
+    int *p = &arr[5];
+    for (int i = 0; i < 100; i++) {
+        arr.push_front(-1);
+        arr.push_back(-1);
+    }
+    for (int i = 0; i < 100; i++) {
+        arr.pop_front();
+        arr.pop_back();
+    }
+    printf("size = %zd, blocks = %zd, address stable: %d\n", arr.size(), arr.m_blocks, p == &arr[5]);
+    for (auto it = arr.begin(); it != arr.end(); ++it)
+        printf("%d ", *it);
+    printf("\n");
+    printf("end - begin = %zd, begin[7] = %d, back = %d\n", arr.end() - arr.begin(), arr.begin()[7], arr.back());
+    Deque<int, 4> copy = arr;
+    arr.clear();
+    printf("copy: ");
+    copy.foreach([] (int &val) {
+        printf("%d ", val);
+    });
+    printf("\n");
+}
+
+template <class D>
+void bench_push_pop(char const *name, size_t n) {
+    char label[96];
+    snprintf(label, sizeof label, "%s push_back", name);
+    D d;
+    benchmark(label, [&] {
+        for (size_t i = 0; i < n; i++)
+            d.push_back((uint32_t)i);
+    }, n);
+    snprintf(label, sizeof label, "%s pop_front", name);
+    benchmark(label, [&] {
+        for (size_t i = 0; i < n; i++)
+            d.pop_front();
+    }, n);
+    snprintf(label, sizeof label, "%s push_front", name);
+    benchmark(label, [&] {
+        for (size_t i = 0; i < n; i++)
+            d.push_front((uint32_t)i);
+    }, n);
+    snprintf(label, sizeof label, "%s pop_back", name);
+    benchmark(label, [&] {
+        for (size_t i = 0; i < n; i++)
+            d.pop_back();
+    }, n);
+    // 队列用法: 尾进头出, 长度保持不变, 块在两端不停地释放和申请
+    for (size_t i = 0; i < 1000; i++)
+        d.push_back((uint32_t)i);
+    snprintf(label, sizeof label, "%s FIFO steady state", name);
+    benchmark(label, [&] {
+        for (size_t i = 0; i < n; i++) {
+            d.push_back((uint32_t)i);
+            d.pop_front();
+        }
+    }, n);
+}
+
+template <class D>
+void bench_index(char const *name, size_t n) {
+    D d;
+    for (size_t i = 0; i < n; i++) {
+        if (i % 2 == 0)
+            d.push_back((uint32_t)i);
+        else
+            d.push_front((uint32_t)i);
+    }
+    std::mt19937 rng(42);
+    std::vector<uint32_t> idx(n);
+    for (auto &i: idx)
+        i = rng() % n;
+    char label[96];
+    snprintf(label, sizeof label, "%s random index", name);
+    benchmark(label, [&] {
+        uint64_t sum = 0;
+        for (uint32_t i: idx)
+            sum += d[i];
+        doNotOptimize(sum);
+    }, n);
+    snprintf(label, sizeof label, "%s sequential index", name);
+    benchmark(label, [&] {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < n; i++)
+            sum += d[i];
+        doNotOptimize(sum);
+    }, n);
+    snprintf(label, sizeof label, "%s iterator", name);
+    benchmark(label, [&] {
+        uint64_t sum = 0;
+        for (auto it = d.begin(); it != d.end(); ++it)
+            sum += *it;
+        doNotOptimize(sum);
+    }, n);
+}
+
+int main() {
+    test_ours();
+    size_t n = 1 << 22;
+    printf("== push/pop at both ends (%zd x uint32_t) ==\n", n);
+    bench_push_pop<Deque<uint32_t>>("Deque", n);
+    bench_push_pop<Deque<uint32_t, 128>>("Deque<512B blocks>", n);
+    bench_push_pop<std::deque<uint32_t>>("std::deque", n);
+    printf("== indexing (%zd x uint32_t) ==\n", n);
+    bench_index<Deque<uint32_t>>("Deque", n);
+    bench_index<std::deque<uint32_t>>("std::deque", n);
+    Deque<uint32_t> d;
+    for (size_t i = 0; i < n; i++)
+        d.push_back((uint32_t)i);
+    benchmark("Deque foreach", [&] {
+        uint64_t sum = 0;
+        d.foreach([&] (uint32_t val) { sum += val; });
+        doNotOptimize(sum);
+    }, n);
+    return 0;
+}
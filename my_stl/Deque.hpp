@@ -0,0 +1,438 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include "Vector.hpp"
+
+// 默认每块约4KB, 至少16个元素; 块内元素个数取2的幂, 下标换算只需要移位和与运算
+template <class T>
+inline constexpr size_t DequeDefaultBlockSize = std::bit_floor(std::max<size_t>(16, 4096 / sizeof(T)));
+
+// 分块双端队列: 元素存在固定大小的块里, 块指针存在一个环形的块表(map)里
+// 两端push只会在块表两端加块, 块表扩容只拷贝块指针, 元素本身从不移动, 引用一直有效
+// 块从分配器成批申请, 空出来的块挂到空闲链表里复用, 不还给分配器
+template <class T, size_t BlockSize = DequeDefaultBlockSize<T>, class Alloc = std::allocator<T>>
+struct Deque {
+    static_assert(BlockSize != 0 && (BlockSize & (BlockSize - 1)) == 0, "BlockSize must be a power of two");
+    static_assert(sizeof(T) * BlockSize >= sizeof(void *), "block too small to hold a free-list link");
+
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using pointer = T *;
+    using const_pointer = T const *;
+    using reference = T &;
+    using const_reference = T const &;
+
+    static constexpr size_t kBlockSize = BlockSize;
+    static constexpr size_t kMaxChunkBlocks = 16;
+
+    using MapAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<T *>;
+
+    struct Chunk {
+        T *m_data;
+        size_t m_blocks;
+    };
+
+    using ChunkAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Chunk>;
+
+    T **m_map;
+    size_t m_map_cap;   // 块表容量, 2的幂
+    size_t m_map_head;  // 第一个块在块表中的位置
+    size_t m_blocks;    // 正在使用的块数
+    size_t m_start;     // 第一个元素在第一个块中的偏移
+    size_t m_size;
+    T *m_spare;         // 空闲块链表, 链接指针就存在块的开头
+    Vector<Chunk, ChunkAlloc> m_chunks;
+    [[no_unique_address]] Alloc m_alloc;
+
+    Deque() noexcept : m_map(nullptr), m_map_cap(0), m_map_head(0), m_blocks(0),
+                       m_start(0), m_size(0), m_spare(nullptr) {}
+
+    explicit Deque(size_t n, T const &val) : Deque() {
+        for (size_t i = 0; i != n; i++)
+            push_back(val);
+    }
+
+    template <std::input_iterator InputIt>
+    Deque(InputIt first, InputIt last) : Deque() {
+        for (; first != last; ++first)
+            push_back(*first);
+    }
+
+    Deque(std::initializer_list<T> ilist) : Deque(ilist.begin(), ilist.end()) {}
+
+    Deque(Deque const &that) : Deque(that.begin(), that.end()) {}
+
+    Deque(Deque &&that) noexcept : Deque() {
+        swap(that);
+    }
+
+    Deque &operator=(Deque const &that) {
+        if (this != &that) [[likely]] {
+            Deque tmp(that);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    Deque &operator=(Deque &&that) noexcept {
+        if (this != &that) [[likely]] {
+            Deque tmp(std::move(that));
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    ~Deque() noexcept {
+        clear();
+        release_memory();
+    }
+
+    template <bool Const>
+    struct Iterator {
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = ptrdiff_t;
+        using pointer = std::conditional_t<Const, T const *, T *>;
+        using reference = std::conditional_t<Const, T const &, T &>;
+        using deque_pointer = std::conditional_t<Const, Deque const *, Deque *>;
+
+        deque_pointer m_deque = nullptr;
+        size_t m_index = 0;
+
+        Iterator() = default;
+        Iterator(deque_pointer d, size_t i) noexcept : m_deque(d), m_index(i) {}
+
+        template <bool C = Const, class = std::enable_if_t<C>>
+        Iterator(Iterator<false> const &that) noexcept : m_deque(that.m_deque), m_index(that.m_index) {}
+
+        reference operator*() const noexcept {
+            return (*m_deque)[m_index];
+        }
+
+        pointer operator->() const noexcept {
+            return std::addressof((*m_deque)[m_index]);
+        }
+
+        reference operator[](difference_type n) const noexcept {
+            return (*m_deque)[m_index + n];
+        }
+
+        Iterator &operator++() noexcept {
+            ++m_index;
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            auto tmp = *this;
+            ++m_index;
+            return tmp;
+        }
+
+        Iterator &operator--() noexcept {
+            --m_index;
+            return *this;
+        }
+
+        Iterator operator--(int) noexcept {
+            auto tmp = *this;
+            --m_index;
+            return tmp;
+        }
+
+        Iterator &operator+=(difference_type n) noexcept {
+            m_index += n;
+            return *this;
+        }
+
+        Iterator &operator-=(difference_type n) noexcept {
+            m_index -= n;
+            return *this;
+        }
+
+        friend Iterator operator+(Iterator it, difference_type n) noexcept {
+            return it += n;
+        }
+
+        friend Iterator operator+(difference_type n, Iterator it) noexcept {
+            return it += n;
+        }
+
+        friend Iterator operator-(Iterator it, difference_type n) noexcept {
+            return it -= n;
+        }
+
+        friend difference_type operator-(Iterator const &a, Iterator const &b) noexcept {
+            return (difference_type)a.m_index - (difference_type)b.m_index;
+        }
+
+        bool operator==(Iterator const &that) const noexcept {
+            return m_index == that.m_index;
+        }
+
+        auto operator<=>(Iterator const &that) const noexcept {
+            return m_index <=> that.m_index;
+        }
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    iterator begin() noexcept {
+        return iterator{this, 0};
+    }
+
+    iterator end() noexcept {
+        return iterator{this, m_size};
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator{this, 0};
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator{this, m_size};
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    reverse_iterator rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+
+    reverse_iterator rend() noexcept {
+        return reverse_iterator(begin());
+    }
+
+    size_t size() const noexcept {
+        return m_size;
+    }
+
+    bool empty() const noexcept {
+        return m_size == 0;
+    }
+
+    T &operator[](size_t i) noexcept {
+        size_t pos = m_start + i;
+        return block_at(pos / BlockSize)[pos & (BlockSize - 1)];
+    }
+
+    T const &operator[](size_t i) const noexcept {
+        size_t pos = m_start + i;
+        return block_at(pos / BlockSize)[pos & (BlockSize - 1)];
+    }
+
+    T &at(size_t i) {
+        if (i >= m_size) [[unlikely]] throw std::out_of_range("deque::at, out of range");
+        return (*this)[i];
+    }
+
+    T const &at(size_t i) const {
+        if (i >= m_size) [[unlikely]] throw std::out_of_range("deque::at, out of range");
+        return (*this)[i];
+    }
+
+    T &front() noexcept {
+        return (*this)[0];
+    }
+
+    T &back() noexcept {
+        return (*this)[m_size - 1];
+    }
+
+    T const &front() const noexcept {
+        return (*this)[0];
+    }
+
+    T const &back() const noexcept {
+        return (*this)[m_size - 1];
+    }
+
+    // 按块遍历, 内层是连续数组
+    template <class Visitor>
+    void foreach(Visitor visitor) {
+        size_t pos = m_start;
+        size_t end = m_start + m_size;
+        while (pos != end) {
+            T *block = block_at(pos / BlockSize);
+            size_t stop = std::min(end, (pos / BlockSize + 1) * BlockSize);
+            for (; pos != stop; pos++)
+                visitor(block[pos & (BlockSize - 1)]);
+        }
+    }
+
+    template <class ...Args>
+    T &emplace_back(Args &&...args) {
+        size_t pos = m_start + m_size;
+        if (pos == m_blocks * BlockSize) [[unlikely]] {
+            reserve_map(m_blocks + 1);
+            m_map[(m_map_head + m_blocks) & (m_map_cap - 1)] = acquire_block();
+            ++m_blocks;
+        }
+        T *p = &block_at(pos / BlockSize)[pos & (BlockSize - 1)];
+        std::construct_at(p, std::forward<Args>(args)...);
+        ++m_size;
+        return *p;
+    }
+
+    template <class ...Args>
+    T &emplace_front(Args &&...args) {
+        if (m_start == 0) [[unlikely]] {
+            reserve_map(m_blocks + 1);
+            m_map_head = (m_map_head - 1) & (m_map_cap - 1);
+            m_map[m_map_head] = acquire_block();
+            ++m_blocks;
+            m_start = BlockSize;
+        }
+        T *p = &block_at(0)[m_start - 1];
+        std::construct_at(p, std::forward<Args>(args)...);
+        --m_start;
+        ++m_size;
+        return *p;
+    }
+
+    void push_back(T const &val) {
+        emplace_back(val);
+    }
+
+    void push_back(T &&val) {
+        emplace_back(std::move(val));
+    }
+
+    void push_front(T const &val) {
+        emplace_front(val);
+    }
+
+    void push_front(T &&val) {
+        emplace_front(std::move(val));
+    }
+
+    void pop_back() noexcept {
+        std::destroy_at(&back());
+        --m_size;
+        size_t used = (m_start + m_size + BlockSize - 1) / BlockSize;
+        if (m_size == 0) {
+            release_all_blocks();
+        } else if (used < m_blocks) {
+            --m_blocks;
+            recycle_block(m_map[(m_map_head + m_blocks) & (m_map_cap - 1)]);
+        }
+    }
+
+    void pop_front() noexcept {
+        std::destroy_at(&front());
+        --m_size;
+        ++m_start;
+        if (m_size == 0) {
+            release_all_blocks();
+        } else if (m_start == BlockSize) {
+            recycle_block(m_map[m_map_head]);
+            m_map_head = (m_map_head + 1) & (m_map_cap - 1);
+            --m_blocks;
+            m_start = 0;
+        }
+    }
+
+    void clear() noexcept {
+        foreach([] (T &val) {
+            std::destroy_at(&val);
+        });
+        m_size = 0;
+        release_all_blocks();
+    }
+
+    // 只有空队列才能把块还给分配器: 成批申请的块只能整批释放
+    void shrink_to_fit() noexcept {
+        if (m_size == 0)
+            release_memory();
+    }
+
+    void swap(Deque &that) noexcept {
+        std::swap(m_map, that.m_map);
+        std::swap(m_map_cap, that.m_map_cap);
+        std::swap(m_map_head, that.m_map_head);
+        std::swap(m_blocks, that.m_blocks);
+        std::swap(m_start, that.m_start);
+        std::swap(m_size, that.m_size);
+        std::swap(m_spare, that.m_spare);
+        m_chunks.swap(that.m_chunks);
+    }
+
+private:
+    T *&block_at(size_t i) const noexcept {
+        return m_map[(m_map_head + i) & (m_map_cap - 1)];
+    }
+
+    // 块表满了就翻倍, 按逻辑顺序把块指针搬到新表开头
+    void reserve_map(size_t blocks) {
+        if (blocks <= m_map_cap) [[likely]]
+            return;
+        size_t new_cap = std::max<size_t>(8, m_map_cap * 2);
+        MapAlloc map_alloc(m_alloc);
+        T **new_map = map_alloc.allocate(new_cap);
+        for (size_t i = 0; i != m_blocks; i++)
+            new_map[i] = block_at(i);
+        if (m_map != nullptr)
+            map_alloc.deallocate(m_map, m_map_cap);
+        m_map = new_map;
+        m_map_cap = new_cap;
+        m_map_head = 0;
+    }
+
+    T *acquire_block() {
+        if (m_spare == nullptr) [[unlikely]] {
+            // 一次申请多块, 批量大小跟着已有块数增长
+            size_t n = std::clamp<size_t>(m_blocks, 1, kMaxChunkBlocks);
+            T *data = m_alloc.allocate(n * BlockSize);
+            m_chunks.push_back(Chunk{data, n});
+            for (size_t i = 0; i != n; i++)
+                recycle_block(data + i * BlockSize);
+        }
+        T *block = m_spare;
+        m_spare = *reinterpret_cast<T **>(block);
+        return block;
+    }
+
+    void recycle_block(T *block) noexcept {
+        *reinterpret_cast<T **>(block) = m_spare;
+        m_spare = block;
+    }
+
+    void release_all_blocks() noexcept {
+        for (size_t i = 0; i != m_blocks; i++)
+            recycle_block(block_at(i));
+        m_blocks = 0;
+        m_map_head = 0;
+        m_start = 0;
+    }
+
+    void release_memory() noexcept {
+        for (Chunk const &chunk: m_chunks)
+            m_alloc.deallocate(chunk.m_data, chunk.m_blocks * BlockSize);
+        m_chunks.clear();
+        m_spare = nullptr;
+        if (m_map != nullptr) {
+            MapAlloc map_alloc(m_alloc);
+            map_alloc.deallocate(m_map, m_map_cap);
+            m_map = nullptr;
+            m_map_cap = 0;
+        }
+    }
+};
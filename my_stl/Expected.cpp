@@ -0,0 +1,184 @@
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Benchmark.hpp"
+#include "Expected.hpp"
+
+enum class ParseError {
+    Empty,
+    BadDigit,
+    Overflow,
+};
+
+char const *to_string(ParseError e) {
+    switch (e) {
+    case ParseError::Empty: return "empty";
+    case ParseError::BadDigit: return "bad digit";
+    case ParseError::Overflow: return "overflow";
+    }
+    return "unknown";
+}
+
+static_assert(std::is_trivially_copyable_v<Expected<int, ParseError>>);
+static_assert(sizeof(Expected<int, ParseError>) == 8);
+static_assert(!std::is_trivially_copyable_v<Expected<std::string, ParseError>>);
+
+constexpr Expected<int, ParseError> parse_int(std::string_view s) {
+    if (s.empty())
+        return makeUnexpected(ParseError::Empty);
+    int value = 0;
+    for (char c: s) {
+        if (c < '0' || c > '9')
+            return makeUnexpected(ParseError::BadDigit);
+        if (value > (INT32_MAX - (c - '0')) / 10)
+            return makeUnexpected(ParseError::Overflow);
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+static_assert(parse_int("123").value() == 123);
+static_assert(parse_int("12x") == makeUnexpected(ParseError::BadDigit));
+
+Expected<int, ParseError> parse_sum(std::string_view a, std::string_view b) {
+    int x = MYSTL_TRY(parse_int(a));
+    MYSTL_TRY_ASSIGN(int y, parse_int(b));
+    return x + y;
+}
+
+void test_ours() {
+    auto r = parse_int("42")
+        .transform([] (int x) { return x * 2; })
+        .and_then([] (int x) -> Expected<int, ParseError> {
+            if (x > 50)
+                return x;
+            return makeUnexpected(ParseError::Overflow);
+        });
+    printf("42 -> %d\n", *r);
+
+    auto bad = parse_int("4x2").transform([] (int x) { return std::to_string(x); });
+    printf("4x2 -> error: %s\n", to_string(bad.error()));
+    auto recovered = parse_int("").or_else([] (ParseError e) -> Expected<int, ParseError> {
+        if (e == ParseError::Empty)
+            return 0;
+        return makeUnexpected(e);
+    });
+    printf("empty recovered -> %d\n", recovered.value());
+
+    auto sum = parse_sum("12", "30");
+    printf("parse_sum(12, 30) = %d\n", sum.value());
+    try {
+        parse_sum("12", "").value();
+    } catch (BadExpectedAccess<ParseError> const &e) {
+        printf("parse_sum(12, \"\"): %s, error = %s\n", e.what(), to_string(e.error()));
+    }
+
+    // 换alternative时拷贝构造抛异常: 原来的错误值还在, 析构时也不会析构两次
+    struct Fragile {
+        std::string m_text;
+        explicit Fragile(std::string text) : m_text(std::move(text)) {}
+        Fragile(Fragile const &that) : m_text(that.m_text) {
+            if (m_text == "boom")
+                throw std::runtime_error("copy failed");
+        }
+        Fragile(Fragile &&) = default;
+        Fragile &operator=(Fragile const &) = default;
+        Fragile &operator=(Fragile &&) = default;
+    };
+    Expected<Fragile, std::string> target = makeUnexpected(std::string("still an error"));
+    Expected<Fragile, std::string> source = Fragile("boom");
+    try {
+        target = source;
+    } catch (std::runtime_error const &) {
+        printf("assign threw, has_value = %d, error = %s\n", target.has_value(), target.error().c_str());
+    }
+    source = Fragile("ok");
+    target = source;
+    printf("assign ok, value = %s\n", target->m_text.c_str());
+}
+
+// 与cpp_home_work里一样的异常层次
+struct ErrorBase {
+    virtual const char *What() const noexcept {
+        return "error undefine";
+    }
+    virtual ~ErrorBase() = default;
+};
+
+struct HttpError : ErrorBase {
+    int m_code;
+
+    explicit HttpError(int code) : m_code(code) {}
+
+    const char *What() const noexcept override {
+        return "404 not found!";
+    }
+};
+
+// 调用链深度为depth, 最深一层按fail决定是否出错, 每层都做一点工作防止被合并成一层
+[[gnu::noinline]] int handle_throw(int depth, uint32_t x, bool fail) {
+    if (depth == 0) {
+        if (fail)
+            throw HttpError(404);
+        return (int)(x & 0xff);
+    }
+    return handle_throw(depth - 1, x * 2654435761u, fail) + 1;
+}
+
+[[gnu::noinline]] Expected<int, int> handle_expected(int depth, uint32_t x, bool fail) {
+    if (depth == 0) {
+        if (fail)
+            return makeUnexpected(404);
+        return (int)(x & 0xff);
+    }
+    int r = MYSTL_TRY(handle_expected(depth - 1, x * 2654435761u, fail));
+    return r + 1;
+}
+
+void bench_error_path(int depth, double failure_rate, size_t n) {
+    std::mt19937 rng(42);
+    std::bernoulli_distribution dist(failure_rate);
+    std::vector<uint8_t> fails(n);
+    for (auto &f: fails)
+        f = dist(rng);
+    char label[96];
+    snprintf(label, sizeof label, "throw    depth %2d, fail %4.1f%%", depth, failure_rate * 100);
+    benchmark(label, [&] {
+        int sum = 0, errors = 0;
+        for (size_t i = 0; i < n; i++) {
+            try {
+                sum += handle_throw(depth, (uint32_t)i, fails[i]);
+            } catch (ErrorBase const &) {
+                ++errors;
+            }
+        }
+        doNotOptimize(sum);
+        doNotOptimize(errors);
+    }, n);
+    snprintf(label, sizeof label, "Expected depth %2d, fail %4.1f%%", depth, failure_rate * 100);
+    benchmark(label, [&] {
+        int sum = 0, errors = 0;
+        for (size_t i = 0; i < n; i++) {
+            auto r = handle_expected(depth, (uint32_t)i, fails[i]);
+            if (r)
+                sum += *r;
+            else
+                ++errors;
+        }
+        doNotOptimize(sum);
+        doNotOptimize(errors);
+    }, n);
+}
+
+int main() {
+    test_ours();
+    for (int depth: {1, 4, 16}) {
+        for (double rate: {0.0, 0.01, 0.1, 0.5})
+            bench_error_path(depth, rate, 200000);
+    }
+    return 0;
+}
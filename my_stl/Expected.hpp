@@ -0,0 +1,343 @@
+#pragma once
+#include <exception>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "Optional.hpp"
+
+// 对Expected取value()但里面是错误时抛出, 带着错误值
+template <class E>
+struct BadExpectedAccess : std::exception {
+    explicit BadExpectedAccess(E error) : m_error(std::move(error)) {}
+
+    const char *what() const noexcept override {
+        return "bad expected access";
+    }
+
+    E const &error() const noexcept {
+        return m_error;
+    }
+
+private:
+    E m_error;
+};
+
+// 包一层用来区分"用错误构造"和"用值构造", T和E是同一类型时也不会歧义
+template <class E>
+struct Unexpected {
+    constexpr explicit Unexpected(E error) : m_error(std::move(error)) {}
+
+    constexpr E const &error() const & noexcept {
+        return m_error;
+    }
+
+    constexpr E &&error() && noexcept {
+        return std::move(m_error);
+    }
+
+private:
+    E m_error;
+};
+
+template <class E>
+constexpr Unexpected<std::decay_t<E>> makeUnexpected(E &&error) {
+    return Unexpected<std::decay_t<E>>(std::forward<E>(error));
+}
+
+// tag类
+struct Unexpect_t {
+    explicit Unexpect_t() = default;
+};
+
+inline constexpr Unexpect_t Unexpect{};
+
+// 要么是值T, 要么是错误E; 错误作为返回值一路传上去, 不走异常的栈展开
+// 布局同Optional: 一个bool加一个union, T和E都平凡时Expected也平凡, 可以放在寄存器里返回
+// 不支持T为void和引用
+template <class T, class E>
+struct Expected {
+    using value_type = T;
+    using error_type = E;
+
+    constexpr Expected() requires std::is_default_constructible_v<T> : m_has_value(true), m_value() {}
+
+    constexpr Expected(T const &value) : m_has_value(true), m_value(value) {}
+    constexpr Expected(T &&value) : m_has_value(true), m_value(std::move(value)) {}
+
+    template <class G>
+    constexpr Expected(Unexpected<G> const &unex) : m_has_value(false), m_error(unex.error()) {}
+
+    template <class G>
+    constexpr Expected(Unexpected<G> &&unex) : m_has_value(false), m_error(std::move(unex).error()) {}
+
+    template <class ...Ts>
+    constexpr explicit Expected(InPlace_t, Ts &&...value_args) : m_has_value(true), m_value(std::forward<Ts>(value_args)...) {}
+
+    template <class ...Ts>
+    constexpr explicit Expected(Unexpect_t, Ts &&...error_args) : m_has_value(false), m_error(std::forward<Ts>(error_args)...) {}
+
+    // 特殊成员函数与Optional一样按T和E是否平凡分两套
+    constexpr Expected(Expected const &) requires (std::is_trivially_copy_constructible_v<T>
+        && std::is_trivially_copy_constructible_v<E>) = default;
+
+    constexpr Expected(Expected const &other) : m_has_value(other.m_has_value) {
+        if (m_has_value)
+            std::construct_at(&m_value, other.m_value);
+        else
+            std::construct_at(&m_error, other.m_error);
+    }
+
+    constexpr Expected(Expected &&) requires (std::is_trivially_move_constructible_v<T>
+        && std::is_trivially_move_constructible_v<E>) = default;
+
+    constexpr Expected(Expected &&other) noexcept(std::is_nothrow_move_constructible_v<T>
+        && std::is_nothrow_move_constructible_v<E>) : m_has_value(other.m_has_value) {
+        if (m_has_value)
+            std::construct_at(&m_value, std::move(other.m_value));
+        else
+            std::construct_at(&m_error, std::move(other.m_error));
+    }
+
+    constexpr Expected &operator=(Expected const &) requires (std::is_trivially_copyable_v<T>
+        && std::is_trivially_copyable_v<E>) = default;
+
+    constexpr Expected &operator=(Expected const &other) {
+        if (this != &other)
+            assign(other);
+        return *this;
+    }
+
+    constexpr Expected &operator=(Expected &&) requires (std::is_trivially_copyable_v<T>
+        && std::is_trivially_copyable_v<E>) = default;
+
+    constexpr Expected &operator=(Expected &&other) noexcept(std::is_nothrow_move_constructible_v<T>
+        && std::is_nothrow_move_constructible_v<E> && std::is_nothrow_move_assignable_v<T>
+        && std::is_nothrow_move_assignable_v<E>) {
+        if (this != &other)
+            assign(std::move(other));
+        return *this;
+    }
+
+    constexpr ~Expected() requires (std::is_trivially_destructible_v<T> && std::is_trivially_destructible_v<E>) = default;
+
+    constexpr ~Expected() noexcept {
+        destroy();
+    }
+
+    constexpr bool has_value() const noexcept {
+        return m_has_value;
+    }
+
+    constexpr explicit operator bool() const noexcept {
+        return m_has_value;
+    }
+
+    constexpr T const &value() const & {
+        if (!m_has_value)
+            throw BadExpectedAccess<E>(m_error);
+        return m_value;
+    }
+
+    constexpr T &value() & {
+        if (!m_has_value)
+            throw BadExpectedAccess<E>(m_error);
+        return m_value;
+    }
+
+    constexpr T &&value() && {
+        if (!m_has_value)
+            throw BadExpectedAccess<E>(std::move(m_error));
+        return std::move(m_value);
+    }
+
+    constexpr E const &error() const & noexcept {
+        return m_error;
+    }
+
+    constexpr E &error() & noexcept {
+        return m_error;
+    }
+
+    constexpr E &&error() && noexcept {
+        return std::move(m_error);
+    }
+
+    constexpr T const &operator*() const & noexcept {
+        return m_value;
+    }
+
+    constexpr T &operator*() & noexcept {
+        return m_value;
+    }
+
+    constexpr T &&operator*() && noexcept {
+        return std::move(m_value);
+    }
+
+    constexpr T const *operator->() const noexcept {
+        return std::addressof(m_value);
+    }
+
+    constexpr T *operator->() noexcept {
+        return std::addressof(m_value);
+    }
+
+    constexpr T value_or(T default_value) const & {
+        if (!m_has_value)
+            return default_value;
+        return m_value;
+    }
+
+    constexpr T value_or(T default_value) && {
+        if (!m_has_value)
+            return default_value;
+        return std::move(m_value);
+    }
+
+    // 有值时调用f(value), f返回另一个错误类型相同的Expected; 有错误时原样传下去
+    template <class F>
+    constexpr auto and_then(F &&f) const & {
+        using RetType = std::remove_cvref_t<std::invoke_result_t<F, T const &>>;
+        static_assert(std::is_same_v<typename RetType::error_type, E>, "and_then must keep the error type");
+        if (m_has_value)
+            return std::invoke(std::forward<F>(f), m_value);
+        return RetType(Unexpect, m_error);
+    }
+
+    template <class F>
+    constexpr auto and_then(F &&f) && {
+        using RetType = std::remove_cvref_t<std::invoke_result_t<F, T &&>>;
+        static_assert(std::is_same_v<typename RetType::error_type, E>, "and_then must keep the error type");
+        if (m_has_value)
+            return std::invoke(std::forward<F>(f), std::move(m_value));
+        return RetType(Unexpect, std::move(m_error));
+    }
+
+    // 有值时把f(value)包成新的Expected, 有错误时原样传下去
+    template <class F>
+    constexpr auto transform(F &&f) const & {
+        using U = std::remove_cvref_t<std::invoke_result_t<F, T const &>>;
+        if (m_has_value)
+            return Expected<U, E>(InPlace, std::invoke(std::forward<F>(f), m_value));
+        return Expected<U, E>(Unexpect, m_error);
+    }
+
+    template <class F>
+    constexpr auto transform(F &&f) && {
+        using U = std::remove_cvref_t<std::invoke_result_t<F, T &&>>;
+        if (m_has_value)
+            return Expected<U, E>(InPlace, std::invoke(std::forward<F>(f), std::move(m_value)));
+        return Expected<U, E>(Unexpect, std::move(m_error));
+    }
+
+    // 有错误时调用f(error)尝试恢复, f返回值类型相同的Expected; 有值时原样传下去
+    template <class F>
+    constexpr auto or_else(F &&f) const & {
+        using RetType = std::remove_cvref_t<std::invoke_result_t<F, E const &>>;
+        static_assert(std::is_same_v<typename RetType::value_type, T>, "or_else must keep the value type");
+        if (m_has_value)
+            return RetType(InPlace, m_value);
+        return std::invoke(std::forward<F>(f), m_error);
+    }
+
+    template <class F>
+    constexpr auto or_else(F &&f) && {
+        using RetType = std::remove_cvref_t<std::invoke_result_t<F, E &&>>;
+        static_assert(std::is_same_v<typename RetType::value_type, T>, "or_else must keep the value type");
+        if (m_has_value)
+            return RetType(InPlace, std::move(m_value));
+        return std::invoke(std::forward<F>(f), std::move(m_error));
+    }
+
+    template <class U, class G>
+    constexpr bool operator==(Expected<U, G> const &other) const {
+        if (m_has_value != other.has_value())
+            return false;
+        if (m_has_value)
+            return m_value == *other;
+        return m_error == other.error();
+    }
+
+    template <class G>
+    constexpr bool operator==(Unexpected<G> const &unex) const {
+        return !m_has_value && m_error == unex.error();
+    }
+
+private:
+    constexpr void destroy() noexcept {
+        if (m_has_value)
+            std::destroy_at(&m_value);
+        else
+            std::destroy_at(&m_error);
+    }
+
+    // 同一个alternative直接赋值; 要换alternative时保证构造抛异常后*this不变(强异常保证)
+    template <class That>
+    constexpr void assign(That &&other) {
+        if (m_has_value && other.m_has_value) {
+            m_value = std::forward<That>(other).m_value;
+        } else if (!m_has_value && !other.m_has_value) {
+            m_error = std::forward<That>(other).m_error;
+        } else if (other.m_has_value) {
+            reinit(m_value, m_error, std::forward<That>(other).m_value);
+            m_has_value = true;
+        } else {
+            reinit(m_error, m_value, std::forward<That>(other).m_error);
+            m_has_value = false;
+        }
+    }
+
+    // 析构旧的alternative, 在同一块内存上构造新的, 做法同std::expected的reinit-expected:
+    // 新值的构造不会抛异常时直接构造; 否则先构造到临时对象里, 新类型移动不抛异常就再移进去;
+    // 都不行时先把旧值移到临时对象里备份, 构造失败再移回来, 这要求旧类型移动不抛异常
+    template <class New, class Old, class ...Args>
+    static constexpr void reinit(New &new_val, Old &old_val, Args &&...args) {
+        if constexpr (std::is_nothrow_constructible_v<New, Args...>) {
+            std::destroy_at(&old_val);
+            std::construct_at(&new_val, std::forward<Args>(args)...);
+        } else if constexpr (std::is_nothrow_move_constructible_v<New>) {
+            New tmp(std::forward<Args>(args)...);
+            std::destroy_at(&old_val);
+            std::construct_at(&new_val, std::move(tmp));
+        } else {
+            static_assert(std::is_nothrow_move_constructible_v<Old>,
+                          "Expected assignment needs T or E to be nothrow move constructible");
+            Old backup(std::move(old_val));
+            std::destroy_at(&old_val);
+            try {
+                std::construct_at(&new_val, std::forward<Args>(args)...);
+            } catch (...) {
+                std::construct_at(&old_val, std::move(backup));
+                throw;
+            }
+        }
+    }
+
+    bool m_has_value;
+    union {
+        T m_value;
+        E m_error;
+    };
+};
+
+// 传播错误: expr是Expected, 有错误时直接从当前函数返回这个错误, 否则整个表达式的值就是里面的值
+// 当前函数的返回类型必须能从Unexpected<E>构造
+// 用到了GCC/Clang的语句表达式, MSVC请用MYSTL_TRY_ASSIGN
+#if defined(__GNUC__)
+#define MYSTL_TRY(expr) ({ \
+    auto &&mystl_try_tmp_ = (expr); \
+    if (!mystl_try_tmp_.has_value()) [[unlikely]] \
+        return makeUnexpected(std::move(mystl_try_tmp_).error()); \
+    *std::move(mystl_try_tmp_); \
+})
+#endif
+
+// 可移植版本: MYSTL_TRY_ASSIGN(auto x, parse(s)); 或者 MYSTL_TRY_ASSIGN(x, parse(s));
+#define MYSTL_TRY_CONCAT_(a, b) a##b
+#define MYSTL_TRY_NAME_(line) MYSTL_TRY_CONCAT_(mystl_try_tmp_, line)
+#define MYSTL_TRY_ASSIGN(lhs, expr) \
+    auto &&MYSTL_TRY_NAME_(__LINE__) = (expr); \
+    if (!MYSTL_TRY_NAME_(__LINE__).has_value()) [[unlikely]] \
+        return makeUnexpected(std::move(MYSTL_TRY_NAME_(__LINE__)).error()); \
+    lhs = *std::move(MYSTL_TRY_NAME_(__LINE__))
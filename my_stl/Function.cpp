@@ -0,0 +1,341 @@
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "Benchmark.hpp"
+#include "Function.hpp"
+
+void test_ours() {
+    int x = 1, y = 2;
+    Function<int(int)> small = [x, y] (int z) { return x + y + z; };
+    std::string big_capture(100, 'a');
+    Function<size_t(int)> big = [big_capture, x, y] (int z) { return big_capture.size() + x + y + z; };
+    printf("small(3) = %d, big(3) = %zd\n", small(3), big(3));
+
+    // 拷贝是真正的拷贝, 各自持有一份状态
+    int counter = 0;
+    Function<int()> f = [counter] () mutable { return ++counter; };
+    Function<int()> g = f;
+    f();
+    f();
+    printf("f() = %d, copy g() = %d\n", f(), g());
+
+    Function<int()> h = std::move(f);
+    printf("moved h() = %d, f empty: %d\n", h(), !f);
+    try {
+        f();
+    } catch (std::runtime_error const &e) {
+        printf("call empty: %s\n", e.what());
+    }
+}
+
+void test_move_only() {
+    // 捕获unique_ptr的lambda只能移动, Function放不下
+    auto buf = std::make_unique<std::string>("buffer");
+    MoveOnlyFunction<size_t() const> size_of = [buf = std::move(buf)] { return buf->size(); };
+    MoveOnlyFunction<size_t() const> moved = std::move(size_of);
+    printf("move-only: size = %zd, source empty: %d\n", moved(), !size_of);
+
+    // &&限定: 只能对右值调用, 可调用对象也按右值调用, 可以把状态移出去
+    MoveOnlyFunction<std::unique_ptr<int>() &&> take = [p = std::make_unique<int>(7)] () mutable { return std::move(p); };
+    auto p = std::move(take)();
+    printf("&&-qualified: *p = %d\n", *p);
+
+    MoveOnlyFunction<int(int) noexcept> twice = [] (int x) noexcept { return x * 2; };
+    static_assert(noexcept(twice(1)));
+    MoveOnlyFunction<void()> null_fp = static_cast<void (*)()>(nullptr);
+    printf("noexcept: twice(21) = %d, from null pointer empty: %d\n", twice(21), !null_fp);
+}
+
+void test_function_ref() {
+    int total = 0;
+    auto add = [&total] (int x) { total += x; };
+    FunctionRef<void(int)> ref = add;
+    ref(3);
+    ref(4);
+    FunctionRef<int(int) const noexcept> neg = +[] (int x) noexcept { return -x; };
+    printf("FunctionRef: total = %d, neg(5) = %d, sizeof = %zd\n", total, neg(5), sizeof(ref));
+}
+
+void test_inplace() {
+    int x = 5;
+    InplaceFunction<int(int) const noexcept> add = [x] (int y) noexcept { return x + y; };
+    // 不可平凡拷贝的捕获也能放, 移动走虚表里的relocate
+    InplaceFunction<size_t(), 48> len = [s = std::string("inplace")] { return s.size(); };
+    InplaceFunction<size_t(), 48> moved = std::move(len);
+    printf("InplaceFunction: add(3) = %d, len() = %zd, source empty: %d, sizeof = %zd\n",
+           add(3), moved(), !len, sizeof(moved));
+    // 放不下的可调用对象编译期报错:
+    // InplaceFunction<void()> too_big = [buf = std::array<char, 64>{}] {};
+}
+
+// 3个指针以内的捕获, 能放进内联缓冲区
+struct SmallCallable {
+    uint64_t m_a, m_b, m_c;
+
+    uint64_t operator()(uint64_t x) const {
+        return x * m_a + m_b - m_c;
+    }
+};
+
+// 超出内联缓冲区, 需要堆分配
+struct BigCallable {
+    uint64_t m_data[8];
+
+    uint64_t operator()(uint64_t x) const {
+        return x * m_data[0] + m_data[7];
+    }
+};
+
+template <template <class> class Fn, class F>
+void bench_construct(char const *name, F f, size_t n) {
+    benchmark(name, [&] {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < n; i++) {
+            Fn<uint64_t(uint64_t)> fn = f;
+            Fn<uint64_t(uint64_t)> copy = fn;
+            sum += copy(i);
+        }
+        doNotOptimize(sum);
+    }, n);
+}
+
+// 只能移动的版本: 构造, 移动一次, 调用
+template <template <class> class Fn, class F>
+void bench_move(char const *name, F f, size_t n) {
+    benchmark(name, [&] {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < n; i++) {
+            Fn<uint64_t(uint64_t)> fn = f;
+            Fn<uint64_t(uint64_t)> moved = std::move(fn);
+            sum += moved(i);
+        }
+        doNotOptimize(sum);
+    }, n);
+}
+
+template <template <class> class Fn, class F>
+void bench_call(char const *name, F f, size_t n) {
+    Fn<uint64_t(uint64_t)> fn = f;
+    doNotOptimize(fn);
+    benchmark(name, [&] {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < n; i++)
+            sum += fn(i);
+        doNotOptimize(sum);
+    }, n);
+}
+
+// 调用延迟: 每次的参数依赖上一次的结果, 多次调用之间没法重叠执行
+template <template <class> class Fn, class F>
+void bench_latency(char const *name, F f, size_t n) {
+    Fn<uint64_t(uint64_t)> fn = f;
+    doNotOptimize(fn);
+    benchmark(name, [&] {
+        uint64_t x = 1;
+        for (size_t i = 0; i < n; i++)
+            x = fn(x);
+        doNotOptimize(x);
+    }, n);
+}
+
+// 以前Function的做法: 虚函数接口加堆上的对象, 作为对照
+struct VirtualCallable {
+    virtual uint64_t operator()(uint64_t x) const = 0;
+    virtual ~VirtualCallable() = default;
+};
+
+template <class F>
+struct VirtualImpl : VirtualCallable {
+    F m_f;
+
+    explicit VirtualImpl(F f) : m_f(std::move(f)) {}
+
+    uint64_t operator()(uint64_t x) const override {
+        return m_f(x);
+    }
+};
+
+template <class Sig>
+struct VirtualFunction;
+
+template <class Ret, class Arg>
+struct VirtualFunction<Ret(Arg)> {
+    std::unique_ptr<VirtualCallable> m_p;
+
+    VirtualFunction() = default;
+
+    template <class F>
+    VirtualFunction(F f) : m_p(std::make_unique<VirtualImpl<F>>(std::move(f))) {}
+
+    Ret operator()(Arg x) const {
+        return (*m_p)(x);
+    }
+};
+
+// 多态调用: 一组函数对象里混着4种可调用对象
+// 按类型成段排列时间接跳转很好预测; 随机排列时每次调用都可能预测失败
+template <template <class> class Fn>
+void bench_polymorphic(char const *name, size_t n, bool shuffled) {
+    constexpr size_t kCount = 4096;
+    std::vector<Fn<uint64_t(uint64_t)>> fns;
+    fns.reserve(kCount);
+    std::mt19937 rng(42);
+    for (size_t i = 0; i < kCount; i++) {
+        size_t kind = shuffled ? rng() % 4 : i * 4 / kCount;
+        switch (kind) {
+        case 0: fns.push_back(SmallCallable{3, 5, 7}); break;
+        case 1: fns.push_back([k = i] (uint64_t x) { return x + k; }); break;
+        case 2: fns.push_back([k = i] (uint64_t x) { return x ^ (x >> 7) ^ k; }); break;
+        default: fns.push_back([] (uint64_t x) { return x * 0x9e3779b97f4a7c15; }); break;
+        }
+    }
+    benchmark(name, [&] {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < n; i += kCount)
+            for (auto const &fn: fns)
+                sum += fn(i);
+        doNotOptimize(sum);
+    }, n);
+}
+
+template <class Sig>
+using StdFunction = std::function<Sig>;
+
+template <class Sig>
+using OurFunction = Function<Sig>;
+
+template <class Sig>
+using OurMoveOnlyFunction = MoveOnlyFunction<Sig>;
+
+template <class Sig>
+using OurInplaceFunction = InplaceFunction<Sig, 64>;
+
+// 定长的任务环形缓冲区: 元素就是函数对象本身, 入队出队都只是移动, 从不分配内存
+template <class Task>
+void bench_ring(char const *name, size_t n) {
+    constexpr size_t kRing = 256;
+    std::vector<Task> ring(kRing);
+    benchmark(name, [&] {
+        uint64_t sum = 0;
+        uint64_t pad[5] = {1, 2, 3, 4, 5};
+        for (size_t i = 0; i < n; i += kRing) {
+            for (size_t k = 0; k < kRing; k++)
+                ring[k] = [i, k, pad] { return i + k * pad[4]; };
+            for (size_t k = 0; k < kRing; k++) {
+                Task task = std::move(ring[k]);
+                sum += task();
+            }
+        }
+        doNotOptimize(sum);
+    }, n);
+}
+
+// 任务队列的典型用法: 捕获一个unique_ptr, 构造一次, 调用一次
+void bench_task(size_t n) {
+    benchmark("MoveOnlyFunction task (unique_ptr)", [&] {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < n; i++) {
+            MoveOnlyFunction<uint64_t()> task = [p = std::make_unique<uint64_t>(i)] { return *p; };
+            MoveOnlyFunction<uint64_t()> queued = std::move(task);
+            sum += queued();
+        }
+        doNotOptimize(sum);
+    }, n);
+    benchmark("std::function task (shared_ptr)", [&] {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < n; i++) {
+            std::function<uint64_t()> task = [p = std::make_shared<uint64_t>(i)] { return *p; };
+            std::function<uint64_t()> queued = std::move(task);
+            sum += queued();
+        }
+        doNotOptimize(sum);
+    }, n);
+}
+
+// 非模板的回调接口: 三种写法传同一个lambda
+[[gnu::noinline]] void for_each_index_ref(size_t n, FunctionRef<void(size_t)> f) {
+    for (size_t i = 0; i < n; i++)
+        f(i);
+}
+
+[[gnu::noinline]] void for_each_index_function(size_t n, Function<void(size_t)> f) {
+    for (size_t i = 0; i < n; i++)
+        f(i);
+}
+
+template <class F>
+[[gnu::noinline]] void for_each_index_template(size_t n, F const &f) {
+    for (size_t i = 0; i < n; i++)
+        f(i);
+}
+
+// 回调接口被频繁调用, 每次只回调少数几次: 传参本身的开销占大头
+void bench_callback(size_t calls, size_t per_call) {
+    printf("== %zd calls of a callback API, %zd callbacks each ==\n", calls, per_call);
+    uint64_t sum = 0;
+    uint64_t big[4] = {1, 2, 3, 4};
+    auto f = [&sum, big] (size_t i) { sum += i * big[0] + big[3]; };
+    benchmark("FunctionRef parameter", [&] {
+        for (size_t k = 0; k < calls; k++)
+            for_each_index_ref(per_call, f);
+    }, calls);
+    benchmark("Function parameter (heap)", [&] {
+        for (size_t k = 0; k < calls; k++)
+            for_each_index_function(per_call, f);
+    }, calls);
+    benchmark("template parameter", [&] {
+        for (size_t k = 0; k < calls; k++)
+            for_each_index_template(per_call, f);
+    }, calls);
+    doNotOptimize(sum);
+}
+
+int main() {
+    test_ours();
+    test_move_only();
+    test_function_ref();
+    test_inplace();
+    size_t n = 1 << 22;
+    SmallCallable small{3, 5, 7};
+    BigCallable big{{3, 0, 0, 0, 0, 0, 0, 5}};
+    printf("== construct + copy + call, sizeof(Function) = %zd, sizeof(std::function) = %zd ==\n",
+           sizeof(Function<void()>), sizeof(std::function<void()>));
+    bench_construct<OurFunction>("Function small (inline)", small, n);
+    bench_construct<StdFunction>("std::function small", small, n);
+    bench_construct<OurFunction>("Function big (heap)", big, n);
+    bench_construct<StdFunction>("std::function big", big, n);
+    bench_move<OurMoveOnlyFunction>("MoveOnlyFunction small (inline)", small, n);
+    bench_move<OurMoveOnlyFunction>("MoveOnlyFunction big (heap)", big, n);
+    bench_move<StdFunction>("std::function small (move)", small, n);
+    bench_move<OurInplaceFunction>("InplaceFunction<64> big (inline)", big, n);
+    printf("== call ==\n");
+    bench_call<OurFunction>("Function small", small, n);
+    bench_call<StdFunction>("std::function small", small, n);
+    bench_call<OurFunction>("Function big", big, n);
+    bench_call<StdFunction>("std::function big", big, n);
+    bench_call<OurMoveOnlyFunction>("MoveOnlyFunction small", small, n);
+    bench_call<OurMoveOnlyFunction>("MoveOnlyFunction big", big, n);
+    bench_call<OurInplaceFunction>("InplaceFunction<64> big", big, n);
+    printf("== call latency (dependent chain) ==\n");
+    bench_latency<OurFunction>("Function small", small, n);
+    bench_latency<StdFunction>("std::function small", small, n);
+    bench_latency<VirtualFunction>("virtual call (old Function)", small, n);
+    for (bool shuffled: {false, true}) {
+        printf("== 4 callable types, %s ==\n", shuffled ? "random order" : "grouped by type");
+        bench_polymorphic<OurFunction>("Function", n, shuffled);
+        bench_polymorphic<StdFunction>("std::function", n, shuffled);
+        bench_polymorphic<VirtualFunction>("virtual call (old Function)", n, shuffled);
+    }
+    printf("== move-only task ==\n");
+    bench_task(n);
+    printf("== fixed-size task ring, 56-byte capture ==\n");
+    bench_ring<InplaceFunction<uint64_t(), 64>>("InplaceFunction<64> ring", n);
+    bench_ring<MoveOnlyFunction<uint64_t()>>("MoveOnlyFunction ring (heap)", n);
+    bench_ring<std::function<uint64_t()>>("std::function ring", n);
+    bench_callback(n, 4);
+    return 0;
+}
@@ -1,61 +1,515 @@
 #pragma once
 
+#include <cstddef>
+#include <cstring>
 #include <utility>
 #include <stdexcept>
 #include <memory>
+#include <new>
 #include <type_traits>
 #include <functional>
 
 
-template <class FnSig>
+// InlineSize: 内联缓冲区能放下的可调用对象大小, 默认3个指针
+// 放得下且移动不抛异常的可调用对象直接构造在Function内部, 否则才在堆上分配
+// 调用函数的指针直接存在Function里, 调用只需一次加载加一次间接调用;
+// 拷贝/移动/析构这些不常用的操作放在每种可调用对象一张的静态表里
+template <class FnSig, size_t InlineSize = 3 * sizeof(void *)>
 struct Function {
     static_assert(!std::is_same_v<FnSig, FnSig>, "not a valid function signature");
 };
 
-template <class Ret, class ...Args>
-struct Function<Ret(Args...)> {
+template <class Ret, class ...Args, size_t InlineSize>
+struct Function<Ret(Args...), InlineSize> {
     private:
-    struct FuncBase {
-        virtual Ret call(Args ...args) = 0;
-        virtual ~FuncBase() = default;
+    // 以前用虚函数的FuncBase: 调用要先从对象里读虚表指针, 再从虚表里读函数地址
+    struct Ops {
+        // 把src里的对象拷贝到dst(放得下时)或者堆上
+        void (*copy)(void *dst, void const *src);
+        // 把src里的对象移到dst, 并析构原对象; 为nullptr时直接拷贝整个缓冲区
+        void (*relocate)(void *dst, void *src) noexcept;
+        void (*destroy)(void *storage) noexcept;
     };
 
+    using Invoker = Ret (*)(void *storage, Args &&...args);
+
+    template <class F>
+    static constexpr bool kFitsInline = sizeof(F) <= InlineSize
+        && alignof(F) <= alignof(void *) && std::is_nothrow_move_constructible_v<F>;
+
+    template <class F>
+    static F *target(void *storage) noexcept {
+        if constexpr (kFitsInline<F>)
+            return std::launder(reinterpret_cast<F *>(storage));
+        else
+            return *static_cast<F **>(storage);
+    }
+
+    template <class F>
+    static Ret do_invoke(void *storage, Args &&...args) {
+        if constexpr (std::is_void_v<Ret>)
+            std::invoke(*target<F>(storage), std::forward<Args>(args)...);
+        else
+            return std::invoke(*target<F>(storage), std::forward<Args>(args)...);
+        // 一样的作用，在另一次题目中我们使用tuple args接受了参数
+        // 然后使用std::apply(m_f,args);来完成函数的调用,
+        // 实质也是使用了std::invoke
+    }
+
+    // 空的Function也有一个调用函数, 这样operator()不需要判空
+    [[noreturn]] static Ret empty_invoke(void *, Args &&...) {
+        throw std::runtime_error("function uninitialized");
+    }
+
+    template <class F>
+    static void do_copy(void *dst, void const *src) {
+        F const &f = *target<F>(const_cast<void *>(src));
+        if constexpr (kFitsInline<F>)
+            ::new (dst) F(f);
+        else
+            *static_cast<F **>(dst) = new F(f);
+    }
+
     template <class F>
-    struct FuncImpl : FuncBase {
-        FuncImpl(F _f) : m_f(std::move(_f)) {}
-
-        virtual Ret call(Args...args) override {
-            return std::invoke(m_f, std::forward<Args>(args)...);
-            /* return m_f(std::forward<Args>(args)...); */
-            /* 一样的作用，在另一次题目中我们使用tuple args接受了参数 */
-            /* 然后使用std::apply(m_f,args);来完成函数的调用, */
-            /* 实质也是使用了std::invoke */
+    static void do_relocate(void *dst, void *src) noexcept {
+        F *f = target<F>(src);
+        ::new (dst) F(std::move(*f));
+        f->~F();
+    }
+
+    template <class F>
+    static void do_destroy(void *storage) noexcept {
+        if constexpr (kFitsInline<F>)
+            target<F>(storage)->~F();
+        else
+            delete target<F>(storage);
+    }
+
+    // 堆上的对象和可平凡拷贝的内联对象, 移动就是拷贝缓冲区
+    template <class F>
+    static constexpr Ops kOps = {&do_copy<F>,
+        (!kFitsInline<F> || std::is_trivially_copyable_v<F>) ? nullptr : &do_relocate<F>, &do_destroy<F>};
+
+    Invoker m_invoke = &empty_invoke;
+    Ops const *m_ops = nullptr;
+    // 清零: 移动时会整个拷贝缓冲区, 包括可调用对象没用到的字节
+    alignas(void *) unsigned char m_buffer[InlineSize] = {};
+    // 以前用shared_ptr, 拷贝Function时共享同一个可调用对象; 现在拷贝是真正的拷贝
+
+    void reset() noexcept {
+        if (m_ops != nullptr) {
+            m_ops->destroy(m_buffer);
+            m_ops = nullptr;
+            m_invoke = &empty_invoke;
         }
+    }
 
-        F m_f;
-    };
-    std::shared_ptr<FuncBase> m_base;
-    // 使用share_ptr, 让Function支持拷贝
+    void move_from(Function &that) noexcept {
+        if (that.m_ops == nullptr)
+            return;
+        if (that.m_ops->relocate != nullptr)
+            that.m_ops->relocate(m_buffer, that.m_buffer);
+        else
+            std::memcpy(m_buffer, that.m_buffer, InlineSize);
+        m_ops = that.m_ops;
+        m_invoke = that.m_invoke;
+        that.m_ops = nullptr;
+        that.m_invoke = &empty_invoke;
+    }
 
 public:
     Function() = default;
-    template <class F, class = std::enable_if_t<std::is_invocable_r_v<Ret, F &, Args...>>>
-    // 使用enable_if_t阻止Function从不可调用的对象中初始化
-#if  __cplusplus > 202002L
-    template <class F> requires (std::is_invocable_v<Ret, F &, Args...>)
-    // C++20 使用requires也能实现相同的约束
-#endif
-    Function(F _f) : m_base(std::make_shared<FuncImpl<F>>(std::move(_f))) {}
+
+    template <class F> requires (std::is_invocable_r_v<Ret, F &, Args...>
+        && !std::is_same_v<std::decay_t<F>, Function>)
+    // C++20 使用requires阻止Function从不可调用的对象中初始化(以前用enable_if_t)
+    Function(F _f) {
+        if constexpr (kFitsInline<F>)
+            ::new (m_buffer) F(std::move(_f));
+        else
+            *reinterpret_cast<F **>(m_buffer) = new F(std::move(_f));
+        m_ops = &kOps<F>;
+        m_invoke = &do_invoke<F>;
+    }
     // 不是用explict,允许lambda隐式转换为function
+
+    Function(Function const &that) {
+        if (that.m_ops != nullptr) {
+            that.m_ops->copy(m_buffer, that.m_buffer);
+            m_ops = that.m_ops;
+            m_invoke = that.m_invoke;
+        }
+    }
+
+    Function(Function &&that) noexcept {
+        move_from(that);
+    }
+
+    Function &operator=(Function const &that) {
+        if (this != &that) {
+            Function tmp(that);
+            reset();
+            move_from(tmp);
+        }
+        return *this;
+    }
+
+    Function &operator=(Function &&that) noexcept {
+        if (this != &that) {
+            reset();
+            move_from(that);
+        }
+        return *this;
+    }
+
+    ~Function() noexcept {
+        reset();
+    }
+
+    explicit operator bool() const noexcept {
+        return m_ops != nullptr;
+    }
+
     Ret operator() (Args ...args) const {
-        if(!m_base) [[unlikely]]
-            throw std::runtime_error("function uninitialized");
-        return m_base->call(std::forward<Args>(args)...);
+        return m_invoke(const_cast<unsigned char *>(m_buffer), std::forward<Args>(args)...);
         // 完美转发，即便Args中存在引用也不产生额外拷贝开销
     }
 
 };
 
+namespace function_detail {
+
+// 手写的虚表: 每种可调用对象一张静态的函数指针表, 对象里只存一个指向它的指针
+// 可调用对象放得下就构造在m_buffer里, 否则(AllowHeap时)在堆上, m_buffer里存指针
+template <size_t Size, size_t Align, bool AllowHeap, class R, bool NE, class ...Args>
+struct ErasedCallable {
+    static_assert(!AllowHeap || (Size >= sizeof(void *) && Align >= alignof(void *)),
+                  "heap fallback needs room for a pointer");
+
+    struct VTable {
+        R (*invoke)(void *storage, Args &&...args) noexcept(NE);
+        // 把storage里的对象移到dst, 并析构原对象; 为nullptr时直接拷贝整个缓冲区
+        void (*relocate)(void *dst, void *src) noexcept;
+        void (*destroy)(void *storage) noexcept;
+    };
+
+    template <class F>
+    static constexpr bool kInline = sizeof(F) <= Size && alignof(F) <= Align
+        && std::is_nothrow_move_constructible_v<F>;
+
+    template <class F>
+    static F *target(void *storage) noexcept {
+        if constexpr (kInline<F>)
+            return std::launder(reinterpret_cast<F *>(storage));
+        else
+            return *static_cast<F **>(storage);
+    }
+
+    // InvF是调用时f的类型, 带上签名里的const和引用限定, 如F const &, F &&
+    template <class F, class InvF>
+    static R do_invoke(void *storage, Args &&...args) noexcept(NE) {
+        if constexpr (std::is_void_v<R>)
+            std::invoke(static_cast<InvF>(*target<F>(storage)), std::forward<Args>(args)...);
+        else
+            return std::invoke(static_cast<InvF>(*target<F>(storage)), std::forward<Args>(args)...);
+    }
+
+    template <class F>
+    static void do_relocate(void *dst, void *src) noexcept {
+        F *f = target<F>(src);
+        ::new (dst) F(std::move(*f));
+        f->~F();
+    }
+
+    template <class F>
+    static void do_destroy(void *storage) noexcept {
+        if constexpr (kInline<F>)
+            target<F>(storage)->~F();
+        else
+            delete target<F>(storage);
+    }
+
+    // 可平凡拷贝的内联对象(只捕获了指针和整数的lambda)和堆上的对象, 移动就是拷贝字节
+    template <class F>
+    static constexpr bool kBitwiseRelocatable = !kInline<F> || std::is_trivially_copyable_v<F>;
+
+    template <class F, class InvF>
+    static constexpr VTable kVTable = {&do_invoke<F, InvF>,
+                                       kBitwiseRelocatable<F> ? nullptr : &do_relocate<F>, &do_destroy<F>};
+
+    VTable const *m_vtable = nullptr;
+    alignas(Align) unsigned char m_buffer[Size];
+
+    ErasedCallable() = default;
+
+    ErasedCallable(ErasedCallable &&that) noexcept {
+        take(that);
+    }
+
+    ErasedCallable &operator=(ErasedCallable &&that) noexcept {
+        if (this != &that) {
+            reset();
+            take(that);
+        }
+        return *this;
+    }
+
+    ~ErasedCallable() noexcept {
+        reset();
+    }
+
+    template <class F, class InvF, class ...Ts>
+    void create(Ts &&...ts) {
+        if constexpr (kInline<F>) {
+            ::new (m_buffer) F(std::forward<Ts>(ts)...);
+        } else {
+            static_assert(AllowHeap, "callable does not fit in the inline buffer");
+            *reinterpret_cast<F **>(m_buffer) = new F(std::forward<Ts>(ts)...);
+        }
+        m_vtable = &kVTable<F, InvF>;
+    }
+
+    // 空的函数指针/成员指针构造出空对象, 同std
+    template <class F>
+    static bool is_null(F const &f) noexcept {
+        if constexpr (std::is_pointer_v<F> || std::is_member_pointer_v<F>)
+            return f == nullptr;
+        else
+            return false;
+    }
+
+    void reset() noexcept {
+        if (m_vtable != nullptr) {
+            m_vtable->destroy(m_buffer);
+            m_vtable = nullptr;
+        }
+    }
+
+    void take(ErasedCallable &that) noexcept {
+        if (that.m_vtable != nullptr) {
+            if (that.m_vtable->relocate != nullptr)
+                that.m_vtable->relocate(m_buffer, that.m_buffer);
+            else
+                std::memcpy(m_buffer, that.m_buffer, Size);
+            m_vtable = that.m_vtable;
+            that.m_vtable = nullptr;
+        }
+    }
+
+    R call(Args &...args) const noexcept(NE) {
+        return m_vtable->invoke(const_cast<unsigned char *>(m_buffer), std::forward<Args>(args)...);
+    }
+};
+
+inline constexpr size_t kDefaultInlineSize = 3 * sizeof(void *);
+
+} // namespace function_detail
+
+// 只能移动的Function: 可以保存捕获了unique_ptr等只能移动的状态的lambda
+// 签名可以带const, &/&&, noexcept, 如MoveOnlyFunction<void(int) const noexcept>, 含义同std::move_only_function
+// 3个指针以内且移动不抛异常的可调用对象内联存放, 否则在堆上
+// 调用空的MoveOnlyFunction是未定义行为(noexcept的签名没法抛异常)
+template <class FnSig>
+struct MoveOnlyFunction {
+    static_assert(!std::is_same_v<FnSig, FnSig>, "not a valid function signature");
+};
+
+// CV, REF: 签名上的限定; INV_REF: 调用可调用对象时用的引用类型(没有引用限定时按左值调用)
+#define MYSTL_MOVE_ONLY_FUNCTION(CV, REF, INV_REF) \
+template <class Ret, class ...Args, bool NE> \
+struct MoveOnlyFunction<Ret(Args...) CV REF noexcept(NE)> { \
+private: \
+    using Erased = function_detail::ErasedCallable<function_detail::kDefaultInlineSize, alignof(void *), true, Ret, NE, Args...>; \
+    Erased m_erased; \
+\
+    template <class F> \
+    static constexpr bool kCallable = NE ? std::is_nothrow_invocable_r_v<Ret, F CV INV_REF, Args...> \
+                                         : std::is_invocable_r_v<Ret, F CV INV_REF, Args...>; \
+\
+public: \
+    MoveOnlyFunction() = default; \
+    MoveOnlyFunction(std::nullptr_t) noexcept {} \
+\
+    template <class F> requires (!std::is_same_v<std::remove_cvref_t<F>, MoveOnlyFunction> \
+        && kCallable<std::decay_t<F>>) \
+    MoveOnlyFunction(F &&f) { \
+        using D = std::decay_t<F>; \
+        if (!Erased::is_null(f)) \
+            m_erased.template create<D, D CV INV_REF>(std::forward<F>(f)); \
+    } \
+\
+    template <class F, class ...Ts> requires kCallable<F> \
+    explicit MoveOnlyFunction(std::in_place_type_t<F>, Ts &&...ts) { \
+        m_erased.template create<F, F CV INV_REF>(std::forward<Ts>(ts)...); \
+    } \
+\
+    MoveOnlyFunction(MoveOnlyFunction &&) noexcept = default; \
+    MoveOnlyFunction &operator=(MoveOnlyFunction &&) noexcept = default; \
+    MoveOnlyFunction(MoveOnlyFunction const &) = delete; \
+    MoveOnlyFunction &operator=(MoveOnlyFunction const &) = delete; \
+\
+    MoveOnlyFunction &operator=(std::nullptr_t) noexcept { \
+        m_erased.reset(); \
+        return *this; \
+    } \
+\
+    explicit operator bool() const noexcept { \
+        return m_erased.m_vtable != nullptr; \
+    } \
+\
+    Ret operator()(Args ...args) CV REF noexcept(NE) { \
+        return m_erased.call(args...); \
+    } \
+\
+    void swap(MoveOnlyFunction &that) noexcept { \
+        std::swap(*this, that); \
+    } \
+};
+
+MYSTL_MOVE_ONLY_FUNCTION(, , &)
+MYSTL_MOVE_ONLY_FUNCTION(const, , &)
+MYSTL_MOVE_ONLY_FUNCTION(, &, &)
+MYSTL_MOVE_ONLY_FUNCTION(const, &, &)
+MYSTL_MOVE_ONLY_FUNCTION(, &&, &&)
+MYSTL_MOVE_ONLY_FUNCTION(const, &&, &&)
+
+#undef MYSTL_MOVE_ONLY_FUNCTION
+
+// 完全内联存放的函数对象, 永远不分配内存, 可以用在禁止堆分配的实时线程里
+// 可调用对象必须放得下Capacity字节且对齐不超过Alignment, 否则编译报错
+// sizeof固定为Capacity加一个虚表指针(按Alignment补齐), 可以作为无锁队列里的定长元素
+// 可平凡拷贝的可调用对象(只捕获了指针和整数的lambda)移动时直接拷贝字节, 其他的通过虚表里的relocate移动
+// 与MoveOnlyFunction一样只能移动, 签名可以带const和noexcept
+template <class FnSig, size_t Capacity = function_detail::kDefaultInlineSize, size_t Alignment = alignof(void *)>
+struct InplaceFunction {
+    static_assert(!std::is_same_v<FnSig, FnSig>, "not a valid function signature");
+};
+
+#define MYSTL_INPLACE_FUNCTION(CV) \
+template <class Ret, class ...Args, bool NE, size_t Capacity, size_t Alignment> \
+struct InplaceFunction<Ret(Args...) CV noexcept(NE), Capacity, Alignment> { \
+private: \
+    using Erased = function_detail::ErasedCallable<Capacity, Alignment, false, Ret, NE, Args...>; \
+    Erased m_erased; \
+\
+    template <class F> \
+    static constexpr bool kCallable = NE ? std::is_nothrow_invocable_r_v<Ret, F CV &, Args...> \
+                                         : std::is_invocable_r_v<Ret, F CV &, Args...>; \
+\
+    template <class F> \
+    static constexpr void check_fits() noexcept { \
+        static_assert(sizeof(F) <= Capacity, "callable is larger than InplaceFunction's Capacity, increase Capacity or capture less"); \
+        static_assert(alignof(F) <= Alignment, "callable is over-aligned for InplaceFunction's Alignment"); \
+        static_assert(std::is_nothrow_move_constructible_v<F>, "InplaceFunction requires a nothrow move constructible callable"); \
+    } \
+\
+public: \
+    static constexpr size_t capacity = Capacity; \
+\
+    InplaceFunction() = default; \
+    InplaceFunction(std::nullptr_t) noexcept {} \
+\
+    template <class F> requires (!std::is_same_v<std::remove_cvref_t<F>, InplaceFunction> \
+        && kCallable<std::decay_t<F>>) \
+    InplaceFunction(F &&f) { \
+        using D = std::decay_t<F>; \
+        check_fits<D>(); \
+        if (!Erased::is_null(f)) \
+            m_erased.template create<D, D CV &>(std::forward<F>(f)); \
+    } \
+\
+    template <class F, class ...Ts> requires kCallable<F> \
+    explicit InplaceFunction(std::in_place_type_t<F>, Ts &&...ts) { \
+        check_fits<F>(); \
+        m_erased.template create<F, F CV &>(std::forward<Ts>(ts)...); \
+    } \
+\
+    InplaceFunction(InplaceFunction &&) noexcept = default; \
+    InplaceFunction &operator=(InplaceFunction &&) noexcept = default; \
+    InplaceFunction(InplaceFunction const &) = delete; \
+    InplaceFunction &operator=(InplaceFunction const &) = delete; \
+\
+    InplaceFunction &operator=(std::nullptr_t) noexcept { \
+        m_erased.reset(); \
+        return *this; \
+    } \
+\
+    explicit operator bool() const noexcept { \
+        return m_erased.m_vtable != nullptr; \
+    } \
+\
+    Ret operator()(Args ...args) CV noexcept(NE) { \
+        return m_erased.call(args...); \
+    } \
+\
+    void swap(InplaceFunction &that) noexcept { \
+        std::swap(*this, that); \
+    } \
+};
+
+MYSTL_INPLACE_FUNCTION()
+MYSTL_INPLACE_FUNCTION(const)
+
+#undef MYSTL_INPLACE_FUNCTION
+
+// 不拥有可调用对象的轻量引用, 只有两个指针: 对象地址和调用它的函数
+// 从不分配内存, 调用就是一次间接调用; 适合做非模板接口的回调参数
+// 只是引用: 被引用的可调用对象必须比FunctionRef活得久, 不要把它存起来
+template <class FnSig>
+struct FunctionRef {
+    static_assert(!std::is_same_v<FnSig, FnSig>, "not a valid function signature");
+};
+
+#define MYSTL_FUNCTION_REF(CV) \
+template <class Ret, class ...Args, bool NE> \
+struct FunctionRef<Ret(Args...) CV noexcept(NE)> { \
+private: \
+    union Bound { \
+        void CV *m_obj; \
+        void (*m_fn)(); \
+    }; \
+\
+    template <class F> \
+    static constexpr bool kCallable = NE ? std::is_nothrow_invocable_r_v<Ret, F, Args...> \
+                                         : std::is_invocable_r_v<Ret, F, Args...>; \
+\
+    Bound m_bound; \
+    Ret (*m_invoke)(Bound, Args &&...) noexcept(NE); \
+\
+public: \
+    /* 函数指针直接保存, 不需要它活着 */ \
+    template <class F> requires std::is_function_v<F> && kCallable<F *> \
+    FunctionRef(F *f) noexcept { \
+        m_bound.m_fn = reinterpret_cast<void (*)()>(f); \
+        m_invoke = [] (Bound b, Args &&...args) noexcept(NE) -> Ret { \
+            return std::invoke(reinterpret_cast<F *>(b.m_fn), std::forward<Args>(args)...); \
+        }; \
+    } \
+\
+    template <class F> requires (!std::is_same_v<std::remove_cvref_t<F>, FunctionRef> \
+        && !std::is_function_v<std::remove_pointer_t<std::remove_cvref_t<F>>> \
+        && kCallable<std::remove_reference_t<F> CV &>) \
+    FunctionRef(F &&f) noexcept { \
+        using T = std::remove_reference_t<F>; \
+        m_bound.m_obj = const_cast<void CV *>(static_cast<void const *>(std::addressof(f))); \
+        m_invoke = [] (Bound b, Args &&...args) noexcept(NE) -> Ret { \
+            return std::invoke(*static_cast<T CV *>(b.m_obj), std::forward<Args>(args)...); \
+        }; \
+    } \
+\
+    FunctionRef(FunctionRef const &) = default; \
+    FunctionRef &operator=(FunctionRef const &) = default; \
+\
+    Ret operator()(Args ...args) const noexcept(NE) { \
+        return m_invoke(m_bound, std::forward<Args>(args)...); \
+    } \
+};
+
+MYSTL_FUNCTION_REF()
+MYSTL_FUNCTION_REF(const)
+
+#undef MYSTL_FUNCTION_REF
+
 /* struct print_arg { */
 /*     void operator()() const { */
 /*         printf("Numbers are: %d, %d\n", x, y); */
@@ -0,0 +1,179 @@
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+#include "Benchmark.hpp"
+#include "IndexList.hpp"
+#include "List.hpp"
+
+// 统计分配字节数的无状态分配器, 所有rebind出来的类型共用一个计数
+inline size_t g_alloc_bytes = 0;
+inline size_t g_alloc_count = 0;
+
+template <class T>
+struct CountingAlloc {
+    using value_type = T;
+
+    CountingAlloc() = default;
+
+    template <class U>
+    CountingAlloc(CountingAlloc<U> const &) noexcept {}
+
+    T *allocate(size_t n) {
+        g_alloc_bytes += n * sizeof(T);
+        ++g_alloc_count;
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T *p, size_t n) noexcept {
+        g_alloc_bytes -= n * sizeof(T);
+        --g_alloc_count;
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    template <class U>
+    bool operator==(CountingAlloc<U> const &) const noexcept {
+        return true;
+    }
+};
+
+static_assert(std::bidirectional_iterator<IndexList<int>::iterator>);
+
+void test_ours() {
+    IndexList<int> arr{1, 2, 3, 4};
+    arr.push_front(0);
+    arr.erase(std::next(arr.begin(), 2));
+    arr.insert(arr.end(), 5);
+    // 刚删掉的槽位被复用
+    printf("size = %zd, slots = %zd, compact = %d\n", arr.size(), arr.slots(), arr.is_compact());
+    arr.foreach([] (int &val) {
+        printf("%d ", val);
+    });
+    printf("\n");
+    arr.compact();
+    printf("after compact: slots = %zd, compact = %d\n", arr.slots(), arr.is_compact());
+    for (auto it = arr.end(); it != arr.begin();) {
+        --it;
+        printf("%d ", *it);
+    }
+    printf("\n");
+
+    // 参数引用的是自己的元素, 而且这次插入要扩容: 不能先释放旧内存再读参数
+    IndexList<std::string> strs;
+    strs.push_back("a string long enough to live on the heap");
+    for (int i = 0; i < 4; i++)
+        strs.push_back(strs.front());
+    printf("self push_back: size = %zd, back = %s\n", strs.size(), strs.back().c_str());
+    strs.remove(strs.front());
+    printf("remove(front()): size = %zd\n", strs.size());
+
+    // 没有默认构造函数的T: 哨兵和空闲槽位上都不构造值
+    struct Tagged {
+        int m_key;
+        char m_tag;
+        Tagged(int key, char tag) : m_key(key), m_tag(tag) {}
+    };
+    IndexList<Tagged> tagged;
+    for (int i = 0; i < 8; i++)
+        tagged.emplace_back(i % 3, char('a' + i));
+    tagged.erase(std::next(tagged.begin(), 4));
+    tagged.emplace_front(1, 'z');
+    // 稳定排序: key相同的保持原来的先后
+    tagged.sort([] (Tagged const &a, Tagged const &b) { return a.m_key < b.m_key; });
+    for (auto const &t: tagged)
+        printf("%d%c ", t.m_key, t.m_tag);
+    printf("\n");
+
+    IndexList<int> odd{1, 3, 5, 7, 9};
+    IndexList<int> even{0, 2, 4, 6, 8};
+    odd.merge(even);
+    printf("merge: size = %zd, other size = %zd:", odd.size(), even.size());
+    for (int x: odd)
+        printf(" %d", x);
+    printf("\n");
+    // 同一个链表内splice只改下标: 把开头三个挪到末尾
+    odd.splice(odd.end(), odd, odd.begin(), std::next(odd.begin(), 3));
+    odd.splice(odd.begin(), odd, std::prev(odd.end()));
+    IndexList<int> extra{100, 200};
+    odd.splice(std::next(odd.begin()), extra);
+    printf("splice: size = %zd, other size = %zd:", odd.size(), extra.size());
+    for (auto it = odd.end(); it != odd.begin();)
+        printf(" %d", *--it);
+    printf(" (reversed)\n");
+}
+
+// glibc malloc每块至少32字节, 有8字节头, 按16字节对齐
+size_t malloc_chunk(size_t bytes) {
+    size_t chunk = (bytes + 8 + 15) & ~size_t(15);
+    return chunk < 32 ? 32 : chunk;
+}
+
+void bench_memory(size_t n) {
+    printf("== memory per element (%zd x uint32_t) ==\n", n);
+    {
+        g_alloc_bytes = g_alloc_count = 0;
+        List<uint32_t, CountingAlloc<uint32_t>> list;
+        for (size_t i = 0; i < n; i++)
+            list.push_back((uint32_t)i);
+        size_t chunk = malloc_chunk(g_alloc_bytes / g_alloc_count);
+        printf("%-24s requested %6.2f B/elem, with malloc header ~%6.2f B/elem\n", "List",
+               (double)g_alloc_bytes / n, (double)chunk * g_alloc_count / n);
+    }
+    {
+        g_alloc_bytes = g_alloc_count = 0;
+        IndexList<uint32_t, CountingAlloc<uint32_t>> list;
+        for (size_t i = 0; i < n; i++)
+            list.push_back((uint32_t)i);
+        printf("%-24s requested %6.2f B/elem (Vector growth slack included)\n", "IndexList",
+               (double)g_alloc_bytes / n);
+        list.compact();
+        printf("%-24s requested %6.2f B/elem\n", "IndexList after compact", (double)g_alloc_bytes / n);
+    }
+}
+
+// 每个新元素插在随机一个已有元素前面, 链表顺序与物理顺序完全不同
+template <class L>
+void scatter(L &list, size_t n) {
+    std::mt19937 rng(42);
+    std::vector<typename L::iterator> iters;
+    iters.reserve(n);
+    iters.push_back(list.insert(list.end(), 0));
+    for (size_t i = 1; i < n; i++)
+        iters.push_back(list.insert(iters[rng() % iters.size()], (uint32_t)i));
+}
+
+template <class L>
+void bench_traverse(char const *name, L &list) {
+    benchmark(name, [&] {
+        uint64_t sum = 0;
+        for (auto it = list.begin(); it != list.end(); ++it)
+            sum += *it;
+        doNotOptimize(sum);
+    }, list.size());
+}
+
+void bench_traversal(size_t n) {
+    printf("== traversal after random inserts (%zd elements) ==\n", n);
+    List<uint32_t> list;
+    std::list<uint32_t> stdlist;
+    IndexList<uint32_t> index_list;
+    scatter(list, n);
+    scatter(stdlist, n);
+    scatter(index_list, n);
+    bench_traverse("List", list);
+    bench_traverse("std::list", stdlist);
+    bench_traverse("IndexList", index_list);
+    benchmark("IndexList::compact", [&] {
+        index_list.compact();
+    }, index_list.size());
+    bench_traverse("IndexList after compact", index_list);
+}
+
+int main() {
+    test_ours();
+    bench_memory(1 << 22);
+    bench_traversal(1 << 22);
+    return 0;
+}
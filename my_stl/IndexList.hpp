@@ -0,0 +1,660 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include "Vector.hpp"
+
+// 下标链表: 值和32位的prev/next下标分别存在三列Vector里(结构体数组 -> 数组结构体)
+// 64位下List的每个节点要16字节指针再加malloc头, 这里每个元素只多8字节
+// 删除的槽位串成空闲链表复用; compact()把物理顺序整理成链表顺序, 之后的遍历是顺序访问
+// 与List一样是带哨兵的循环链表, 哨兵固定是0号槽位
+// 值列是未初始化的原始内存, 只有链表里的槽位上构造了T, 哨兵和空闲槽位上没有值, T不需要能默认构造
+template <class T, class Alloc = std::allocator<T>>
+struct IndexList {
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using pointer = T *;
+    using const_pointer = T const *;
+    using reference = T &;
+    using const_reference = T const &;
+    using index_type = uint32_t;
+
+    using IndexAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<index_type>;
+
+    static constexpr index_type npos = UINT32_MAX;
+    // 空闲槽位的prev标记为npos, 空闲链表通过next串起来
+
+    // 槽位数以m_next.size()为准, m_capacity是值列能放下的槽位数
+    T *m_values;
+    size_t m_capacity;
+    Vector<index_type, IndexAlloc> m_next;
+    Vector<index_type, IndexAlloc> m_prev;
+    index_type m_free;
+    size_t m_size;
+
+    IndexList() : m_values(nullptr), m_capacity(0) {
+        m_next.push_back(0);
+        m_prev.push_back(0);
+        m_free = npos;
+        m_size = 0;
+    }
+
+    explicit IndexList(size_t n, T const &val) : IndexList() {
+        reserve(n);
+        for (size_t i = 0; i < n; i++)
+            push_back(val);
+    }
+
+    template <std::input_iterator InputIt>
+    IndexList(InputIt first, InputIt last) : IndexList() {
+        for (; first != last; ++first)
+            push_back(*first);
+    }
+
+    IndexList(std::initializer_list<T> ilist)
+    : IndexList(ilist.begin(), ilist.end()) {}
+
+    // 下标列原样拷贝, 值拷到同号槽位上, 下标不需要修正
+    IndexList(IndexList const &that)
+    : m_values(nullptr), m_capacity(0), m_next(that.m_next), m_prev(that.m_prev), m_free(that.m_free), m_size(that.m_size) {
+        T *values = allocator{}.allocate(that.slots());
+        index_type i = m_next[0];
+        try {
+            for (; i != 0; i = m_next[i])
+                std::construct_at(&values[i], that.m_values[i]);
+        } catch (...) {
+            for (index_type j = m_next[0]; j != i; j = m_next[j])
+                std::destroy_at(&values[j]);
+            allocator{}.deallocate(values, that.slots());
+            throw;
+        }
+        m_values = values;
+        m_capacity = that.slots();
+    }
+
+    IndexList &operator=(IndexList const &that) {
+        if (this != &that) [[likely]] {
+            IndexList tmp(that);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    // 被移走的链表要重新放一个哨兵, 会分配内存, 所以不是noexcept
+    IndexList(IndexList &&that)
+    : m_values(std::exchange(that.m_values, nullptr)), m_capacity(std::exchange(that.m_capacity, 0)),
+      m_next(std::move(that.m_next)), m_prev(std::move(that.m_prev)), m_free(that.m_free), m_size(that.m_size) {
+        that.reset_empty();
+    }
+
+    IndexList &operator=(IndexList &&that) {
+        if (this != &that) [[likely]] {
+            IndexList tmp(std::move(that));
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    ~IndexList() {
+        destroy_values();
+        if (m_values != nullptr)
+            allocator{}.deallocate(m_values, m_capacity);
+    }
+
+    // 迭代器只存链表指针和下标, 列扩容之后依然有效
+    template <bool Const>
+    struct Iterator {
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = ptrdiff_t;
+        using pointer = std::conditional_t<Const, T const *, T *>;
+        using reference = std::conditional_t<Const, T const &, T &>;
+        using list_pointer = std::conditional_t<Const, IndexList const *, IndexList *>;
+
+        list_pointer list = nullptr;
+        index_type curr = 0;
+
+        Iterator() = default;
+        Iterator(list_pointer l, index_type i) noexcept : list(l), curr(i) {}
+
+        template <bool C = Const, class = std::enable_if_t<C>>
+        Iterator(Iterator<false> const &that) noexcept : list(that.list), curr(that.curr) {}
+
+        Iterator &operator++() noexcept {
+            curr = list->m_next[curr];
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        Iterator &operator--() noexcept {
+            curr = list->m_prev[curr];
+            return *this;
+        }
+
+        Iterator operator--(int) noexcept {
+            auto tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        reference operator*() const noexcept {
+            return list->m_values[curr];
+        }
+
+        pointer operator->() const noexcept {
+            return std::addressof(list->m_values[curr]);
+        }
+
+        bool operator==(Iterator const &that) const noexcept {
+            return curr == that.curr;
+        }
+
+        bool operator!=(Iterator const &that) const noexcept {
+            return curr != that.curr;
+        }
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    iterator begin() noexcept {
+        return iterator{this, m_next[0]};
+    }
+
+    iterator end() noexcept {
+        return iterator{this, 0};
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator{this, m_next[0]};
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator{this, 0};
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    template <class Visitor>
+    void foreach(Visitor visitor) {
+        for (index_type i = m_next[0]; i != 0; i = m_next[i])
+            visitor(m_values[i]);
+    }
+
+    bool empty() const noexcept {
+        return m_size == 0;
+    }
+
+    size_t size() const noexcept {
+        return m_size;
+    }
+
+    // 已占用的槽位数(含哨兵和空闲槽位)
+    size_t slots() const noexcept {
+        return m_next.size();
+    }
+
+    void reserve(size_t n) {
+        m_next.reserve(n + 1);
+        m_prev.reserve(n + 1);
+        if (n + 1 > m_capacity)
+            replace_values(n + 1);
+    }
+
+    T &front() noexcept {
+        return m_values[m_next[0]];
+    }
+
+    T &back() noexcept {
+        return m_values[m_prev[0]];
+    }
+
+    T const &front() const noexcept {
+        return m_values[m_next[0]];
+    }
+
+    T const &back() const noexcept {
+        return m_values[m_prev[0]];
+    }
+
+    // 优先复用空闲槽位; 值构造成功之后才改下标, 构造抛异常时链表不变
+    template <class ...Args>
+    iterator emplace(const_iterator pos, Args &&...args) {
+        index_type i;
+        if (m_free != npos) {
+            i = m_free;
+            std::construct_at(&m_values[i], std::forward<Args>(args)...);
+            m_free = m_next[i];
+        } else {
+            size_t n = slots();
+            if (n >= npos) [[unlikely]]
+                throw std::length_error("IndexList: too many elements");
+            // 先给下标列留好位置, 值构造成功之后的push_back不会再抛异常
+            m_next.reserve(n + 1);
+            m_prev.reserve(n + 1);
+            i = (index_type)n;
+            // 空链表的值列可以还没分配, 这时容量比槽位数(只有哨兵)还小
+            if (n >= m_capacity)
+                grow_emplace(i, std::forward<Args>(args)...);
+            else
+                std::construct_at(&m_values[i], std::forward<Args>(args)...);
+            m_next.push_back(0);
+            m_prev.push_back(0);
+        }
+        index_type next = pos.curr;
+        index_type prev = m_prev[next];
+        m_next[i] = next;
+        m_prev[i] = prev;
+        m_next[prev] = i;
+        m_prev[next] = i;
+        ++m_size;
+        return iterator{this, i};
+    }
+
+    iterator insert(const_iterator pos, T const &val) {
+        return emplace(pos, val);
+    }
+
+    iterator insert(const_iterator pos, T &&val) {
+        return emplace(pos, std::move(val));
+    }
+
+    template <class ...Args>
+    T &emplace_back(Args &&...args) {
+        return *emplace(end(), std::forward<Args>(args)...);
+    }
+
+    template <class ...Args>
+    T &emplace_front(Args &&...args) {
+        return *emplace(begin(), std::forward<Args>(args)...);
+    }
+
+    void push_back(T const &val) {
+        emplace(end(), val);
+    }
+
+    void push_back(T &&val) {
+        emplace(end(), std::move(val));
+    }
+
+    void push_front(T const &val) {
+        emplace(begin(), val);
+    }
+
+    void push_front(T &&val) {
+        emplace(begin(), std::move(val));
+    }
+
+    iterator erase(const_iterator pos) {
+        index_type i = pos.curr;
+        index_type next = m_next[i];
+        index_type prev = m_prev[i];
+        m_next[prev] = next;
+        m_prev[next] = prev;
+        std::destroy_at(&m_values[i]);
+        m_prev[i] = npos;
+        m_next[i] = m_free;
+        m_free = i;
+        --m_size;
+        return iterator{this, next};
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        while (first != last)
+            first = erase(first);
+        return iterator{this, last.curr};
+    }
+
+    void pop_back() {
+        erase(const_iterator{this, m_prev[0]});
+    }
+
+    void pop_front() {
+        erase(const_iterator{this, m_next[0]});
+    }
+
+    template <class Pred>
+    size_t remove_if(Pred pred) {
+        size_t old_size = m_size;
+        for (index_type i = m_next[0]; i != 0;) {
+            index_type next = m_next[i];
+            if (pred(m_values[i]))
+                erase(const_iterator{this, i});
+            i = next;
+        }
+        return old_size - m_size;
+    }
+
+    // val可能就是链表里某个元素的引用(比如l.remove(l.front())), 同List: 持有val的槽位等比较完所有元素再删
+    size_t remove(T const &val) {
+        size_t old_size = m_size;
+        index_type deferred = 0;
+        for (index_type i = m_next[0]; i != 0;) {
+            index_type next = m_next[i];
+            if (m_values[i] == val) {
+                if (std::addressof(m_values[i]) == std::addressof(val))
+                    deferred = i;
+                else
+                    erase(const_iterator{this, i});
+            }
+            i = next;
+        }
+        if (deferred != 0)
+            erase(const_iterator{this, deferred});
+        return old_size - m_size;
+    }
+
+    void clear() {
+        destroy_values();
+        m_next.resize(1);
+        m_prev.resize(1);
+        reset_empty_links();
+    }
+
+    void swap(IndexList &that) noexcept {
+        std::swap(m_values, that.m_values);
+        std::swap(m_capacity, that.m_capacity);
+        m_next.swap(that.m_next);
+        m_prev.swap(that.m_prev);
+        std::swap(m_free, that.m_free);
+        std::swap(m_size, that.m_size);
+    }
+
+    // 同一个链表内的splice只改下标, 不移动值, 和List一样是O(1)
+    // 不同链表的槽位不通用, 只能把值逐个移动过来再从that里删掉, 是O(n), 被移动元素的迭代器失效
+    // 整个that接到pos前面
+    void splice(const_iterator pos, IndexList &that) {
+        if (this == &that || that.empty())
+            return;
+        splice(pos, that, that.begin(), that.end());
+    }
+
+    void splice(const_iterator pos, IndexList &&that) {
+        splice(pos, that);
+    }
+
+    // 把that中的单个元素it接到pos前面
+    void splice(const_iterator pos, IndexList &that, const_iterator it) {
+        index_type i = it.curr;
+        if (this == &that) {
+            if (i == pos.curr || m_next[i] == pos.curr)
+                return;
+            transfer(pos.curr, i, m_next[i]);
+            return;
+        }
+        emplace(pos, std::move(that.m_values[i]));
+        that.erase(it);
+    }
+
+    void splice(const_iterator pos, IndexList &&that, const_iterator it) {
+        splice(pos, that, it);
+    }
+
+    // 把that中的[first, last)接到pos前面
+    void splice(const_iterator pos, IndexList &that, const_iterator first, const_iterator last) {
+        if (first == last)
+            return;
+        if (this == &that) {
+            transfer(pos.curr, first.curr, last.curr);
+            return;
+        }
+        while (first != last) {
+            emplace(pos, std::move(that.m_values[first.curr]));
+            first = that.erase(first);
+        }
+    }
+
+    void splice(const_iterator pos, IndexList &&that, const_iterator first, const_iterator last) {
+        splice(pos, that, first, last);
+    }
+
+    // 两个有序链表归并, 稳定; 与List不同, that的值要移动到this的槽位里, 最后清空that
+    template <class Compare>
+    void merge(IndexList &that, Compare comp) {
+        if (this == &that)
+            return;
+        index_type curr = m_next[0];
+        index_type other = that.m_next[0];
+        while (curr != 0 && other != 0) {
+            if (comp(that.m_values[other], m_values[curr])) {
+                emplace(const_iterator{this, curr}, std::move(that.m_values[other]));
+                other = that.m_next[other];
+            } else {
+                curr = m_next[curr];
+            }
+        }
+        for (; other != 0; other = that.m_next[other])
+            emplace(end(), std::move(that.m_values[other]));
+        that.clear();
+    }
+
+    void merge(IndexList &that) {
+        merge(that, std::less<>());
+    }
+
+    void merge(IndexList &&that) {
+        merge(that, std::less<>());
+    }
+
+    template <class Compare>
+    void merge(IndexList &&that, Compare comp) {
+        merge(that, comp);
+    }
+
+    // 同List::sort: 自底向上的归并排序, 只改下标, 不移动值, 稳定
+    // 排序时只维护m_next, 以0号哨兵作为单链表的结尾, 最后一次遍历补回m_prev
+    template <class Compare>
+    void sort(Compare comp) {
+        if (m_size < 2)
+            return;
+        index_type bins[64] = {};
+        size_t max_bin = 0;
+        index_type curr = m_next[0];
+        while (curr != 0) {
+            index_type next = m_next[curr];
+            m_next[curr] = 0;
+            index_type run = curr;
+            size_t i = 0;
+            for (; bins[i] != 0; i++) {
+                // bins[i]里的元素更靠前, 放在左边保证稳定
+                run = merge_runs(bins[i], run, comp);
+                bins[i] = 0;
+            }
+            bins[i] = run;
+            if (i > max_bin)
+                max_bin = i;
+            curr = next;
+        }
+        index_type result = 0;
+        for (size_t i = 0; i <= max_bin; i++) {
+            if (bins[i] != 0)
+                result = merge_runs(bins[i], result, comp);
+        }
+        index_type prev = 0;
+        for (curr = result; curr != 0; curr = m_next[curr]) {
+            m_next[prev] = curr;
+            m_prev[curr] = prev;
+            prev = curr;
+        }
+        m_next[prev] = 0;
+        m_prev[0] = prev;
+    }
+
+    void sort() {
+        sort(std::less<>());
+    }
+
+    // 按链表顺序重排三列, 丢掉空闲槽位; 之后第k个元素就在k+1号槽位
+    // 所有迭代器失效
+    void compact() {
+        index_type n = (index_type)m_size;
+        Vector<index_type, IndexAlloc> next;
+        Vector<index_type, IndexAlloc> prev;
+        next.reserve(n + 1);
+        prev.reserve(n + 1);
+        for (index_type k = 0; k <= n; k++) {
+            next.push_back(k == n ? 0 : k + 1);
+            prev.push_back(k == 0 ? n : k - 1);
+        }
+        T *values = allocator{}.allocate(n + 1);
+        index_type k = 1;
+        try {
+            for (index_type i = m_next[0]; i != 0; i = m_next[i], k++)
+                std::construct_at(&values[k], std::move_if_noexcept(m_values[i]));
+        } catch (...) {
+            std::destroy(values + 1, values + k);
+            allocator{}.deallocate(values, n + 1);
+            throw;
+        }
+        destroy_values();
+        if (m_values != nullptr)
+            allocator{}.deallocate(m_values, m_capacity);
+        m_values = values;
+        m_capacity = n + 1;
+        m_next = std::move(next);
+        m_prev = std::move(prev);
+        m_free = npos;
+    }
+
+    // 物理顺序是否与链表顺序一致
+    bool is_compact() const noexcept {
+        if (m_free != npos || slots() != m_size + 1)
+            return false;
+        for (index_type k = 0; k < m_size; k++) {
+            if (m_next[k] != k + 1)
+                return false;
+        }
+        return true;
+    }
+
+private:
+    using allocator = Alloc;
+
+    void reset_empty_links() noexcept {
+        m_next[0] = 0;
+        m_prev[0] = 0;
+        m_free = npos;
+        m_size = 0;
+    }
+
+    // 被移走之后恢复成只有哨兵的空链表, 值列已经被拿走
+    void reset_empty() {
+        m_next.clear();
+        m_prev.clear();
+        m_next.push_back(0);
+        m_prev.push_back(0);
+        reset_empty_links();
+    }
+
+    // 只有链表里的槽位上有值
+    void destroy_values() noexcept {
+        for (index_type i = m_next[0]; i != 0; i = m_next[i])
+            std::destroy_at(&m_values[i]);
+    }
+
+    // 把链表里的值搬到dst的同号槽位, 再析构原来的
+    // 用move_if_noexcept, 搬动抛异常时原来的值都还在, 析构dst里已经搬好的
+    void relocate_values(T *dst) {
+        index_type i = m_next[0];
+        try {
+            for (; i != 0; i = m_next[i])
+                std::construct_at(&dst[i], std::move_if_noexcept(m_values[i]));
+        } catch (...) {
+            for (index_type j = m_next[0]; j != i; j = m_next[j])
+                std::destroy_at(&dst[j]);
+            throw;
+        }
+        destroy_values();
+    }
+
+    void replace_values(size_t cap) {
+        T *values = allocator{}.allocate(cap);
+        try {
+            relocate_values(values);
+        } catch (...) {
+            allocator{}.deallocate(values, cap);
+            throw;
+        }
+        if (m_values != nullptr)
+            allocator{}.deallocate(m_values, m_capacity);
+        m_values = values;
+        m_capacity = cap;
+    }
+
+    // 值列的扩容路径, 顺序同Vector::grow_emplace_back: 分配 -> 构造新值 -> 搬移旧值 -> 释放旧内存
+    // args引用的旧值在新值构造完之前一直有效
+    template <class ...Args>
+    [[gnu::noinline]] void grow_emplace(index_type i, Args &&...args) {
+        size_t cap = std::max(size_t(i) + 1, m_capacity * 2);
+        T *values = allocator{}.allocate(cap);
+        try {
+            std::construct_at(&values[i], std::forward<Args>(args)...);
+        } catch (...) {
+            allocator{}.deallocate(values, cap);
+            throw;
+        }
+        try {
+            relocate_values(values);
+        } catch (...) {
+            std::destroy_at(&values[i]);
+            allocator{}.deallocate(values, cap);
+            throw;
+        }
+        if (m_values != nullptr)
+            allocator{}.deallocate(m_values, m_capacity);
+        m_values = values;
+        m_capacity = cap;
+    }
+
+    // 把[first, last)从原位置摘下, 接到pos前面, 同List::transfer
+    void transfer(index_type pos, index_type first, index_type last) noexcept {
+        if (pos == last)
+            return;
+        index_type tail = m_prev[last];
+        m_next[m_prev[first]] = last;
+        m_prev[last] = m_prev[first];
+        m_prev[first] = m_prev[pos];
+        m_next[tail] = pos;
+        m_next[m_prev[pos]] = first;
+        m_prev[pos] = tail;
+    }
+
+    // 合并两个以0结尾的有序单链表
+    template <class Compare>
+    index_type merge_runs(index_type a, index_type b, Compare &comp) {
+        index_type head = 0;
+        index_type *tail = &head;
+        while (a != 0 && b != 0) {
+            if (comp(m_values[b], m_values[a])) {
+                *tail = b;
+                tail = &m_next[b];
+                b = m_next[b];
+            } else {
+                *tail = a;
+                tail = &m_next[a];
+                a = m_next[a];
+            }
+        }
+        *tail = a != 0 ? a : b;
+        return head;
+    }
+};
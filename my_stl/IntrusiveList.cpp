@@ -0,0 +1,64 @@
+#include <cstdio>
+#include <iterator>
+#include "IntrusiveList.hpp"
+
+// 一个定时器同时挂在"全部定时器"和"等待队列"两个链表上
+struct Timer {
+    int m_id;
+    IntrusiveListHook m_all_hook;
+    IntrusiveListHook m_wait_hook;
+};
+
+using AllList = IntrusiveList<Timer, &Timer::m_all_hook>;
+using WaitList = IntrusiveList<Timer, &Timer::m_wait_hook>;
+
+static_assert(std::bidirectional_iterator<AllList::iterator>);
+static_assert(std::bidirectional_iterator<AllList::const_iterator>);
+
+// 只读遍历用const_iterator
+int sum_ids(AllList const &list) {
+    int sum = 0;
+    for (Timer const &t: list)
+        sum += t.m_id;
+    return sum;
+}
+
+int main() {
+    Timer pool[6];
+    // 对象已经在池子里, 链表只串钩子, 不分配
+    AllList all;
+    WaitList wait;
+    for (int i = 0; i < 6; i++) {
+        pool[i].m_id = i;
+        all.push_back(pool[i]);
+        if (i % 2 == 0)
+            wait.push_front(pool[i]);
+    }
+
+    all.foreach([] (Timer &t) {
+        printf("all: %d\n", t.m_id);
+    });
+    for (auto it = wait.begin(); it != wait.end(); ++it) {
+        printf("wait: %d\n", it->m_id);
+    }
+
+    // 直接通过对象摘除, 另一个链表不受影响
+    WaitList::erase(pool[2]);
+    all.move_to_back(pool[0]);
+    printf("wait.size() = %zd, all.front() = %d, all.back() = %d, sum of ids = %d\n",
+           wait.size(), all.front().m_id, all.back().m_id, sum_ids(all));
+
+    {
+        Timer tmp{42, {}, {}};
+        wait.push_back(tmp);
+        printf("wait.size() = %zd\n", wait.size());
+    }
+    // tmp析构时自动从wait上摘掉
+    printf("wait.size() = %zd\n", wait.size());
+
+    while (!wait.empty()) {
+        Timer &t = wait.pop_front();
+        printf("pop wait: %d, still in all: %d\n", t.m_id, t.m_all_hook.is_linked());
+    }
+    return 0;
+}
@@ -0,0 +1,340 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include "ContainerOf.hpp"
+
+// 侵入式链表: 对象自己内嵌prev/next钩子, 链表只负责把钩子串起来
+// 插入和删除都是O(1), 且完全不分配内存 (对象本身的内存由使用者的池子管理)
+// 一个对象内嵌多个钩子, 就可以同时挂在多个链表上 (定时器, LRU, 等待队列)
+
+// 定义MYSTL_SAFE_UNLINK后会检查钩子前后指针的一致性
+// 默认在Debug构建(没有NDEBUG)时开启
+#if !defined(MYSTL_SAFE_UNLINK) && !defined(NDEBUG)
+#define MYSTL_SAFE_UNLINK 1
+#endif
+
+struct IntrusiveListHook {
+    IntrusiveListHook *m_next = nullptr;
+    IntrusiveListHook *m_prev = nullptr;
+    // 未链接时两个指针都是nullptr
+
+    IntrusiveListHook() noexcept = default;
+
+    // 拷贝对象不应该拷贝它所在的链表位置, 新对象的钩子总是未链接的
+    IntrusiveListHook(IntrusiveListHook const &) noexcept {}
+
+    IntrusiveListHook &operator=(IntrusiveListHook const &) noexcept {
+        return *this;
+    }
+
+    // 对象析构时自动从链表中摘除, 避免链表里留下悬垂指针
+    ~IntrusiveListHook() noexcept {
+        if (is_linked())
+            unlink();
+    }
+
+    bool is_linked() const noexcept {
+        return m_next != nullptr;
+    }
+
+    // 不需要知道自己在哪个链表里就可以摘除, 定时器取消时很方便
+    void unlink() noexcept {
+#if MYSTL_SAFE_UNLINK
+        assert(is_linked() && "unlink of an unlinked hook");
+        assert(m_next->m_prev == this && m_prev->m_next == this && "list corrupted");
+#endif
+        m_prev->m_next = m_next;
+        m_next->m_prev = m_prev;
+        m_next = nullptr;
+        m_prev = nullptr;
+    }
+
+    // 把this插到pos的前面
+    void link_before(IntrusiveListHook *pos) noexcept {
+#if MYSTL_SAFE_UNLINK
+        assert(!is_linked() && "hook is already in a list");
+        assert(pos->m_prev->m_next == pos && "list corrupted");
+#endif
+        m_next = pos;
+        m_prev = pos->m_prev;
+        pos->m_prev->m_next = this;
+        pos->m_prev = this;
+    }
+};
+
+template <class T, IntrusiveListHook T::*Hook>
+struct IntrusiveList {
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using pointer = T *;
+    using const_pointer = T const *;
+    using reference = T &;
+    using const_reference = T const &;
+
+    // 与List一样是循环链表, 但用一个哨兵钩子代替m_head
+    // 这样空链表不需要特判, end()就是哨兵本身
+    IntrusiveListHook m_dummy;
+
+    IntrusiveList() noexcept {
+        m_dummy.m_next = &m_dummy;
+        m_dummy.m_prev = &m_dummy;
+    }
+
+    IntrusiveList(IntrusiveList const &) = delete;
+    IntrusiveList &operator=(IntrusiveList const &) = delete;
+
+    IntrusiveList(IntrusiveList &&that) noexcept : IntrusiveList() {
+        swap(that);
+    }
+
+    IntrusiveList &operator=(IntrusiveList &&that) noexcept {
+        if (this != &that) [[likely]] {
+            clear();
+            swap(that);
+        }
+        return *this;
+    }
+
+    // 链表不拥有对象, 析构只把所有钩子摘下来
+    ~IntrusiveList() noexcept {
+        clear();
+        m_dummy.m_next = nullptr;
+        m_dummy.m_prev = nullptr;
+    }
+
+    // 利用成员指针算出钩子在T中的偏移, 从钩子反推出对象
+    static T *to_value(IntrusiveListHook *hook) noexcept {
+        return container_of(hook, Hook);
+    }
+
+    static T const *to_value(IntrusiveListHook const *hook) noexcept {
+        return container_of(hook, Hook);
+    }
+
+    static IntrusiveListHook *to_hook(T &value) noexcept {
+        return &(value.*Hook);
+    }
+
+    template <bool Const>
+    struct Iterator {
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = ptrdiff_t;
+        using pointer = std::conditional_t<Const, T const *, T *>;
+        using reference = std::conditional_t<Const, T const &, T &>;
+        using hook_pointer = std::conditional_t<Const, IntrusiveListHook const *, IntrusiveListHook *>;
+
+        hook_pointer curr = nullptr;
+
+        Iterator() = default;
+        Iterator(hook_pointer hook) noexcept : curr(hook) {}
+
+        // iterator可以隐式转为const_iterator
+        template <bool C = Const, class = std::enable_if_t<C>>
+        Iterator(Iterator<false> const &that) noexcept : curr(that.curr) {}
+
+        Iterator &operator++() noexcept {
+            curr = curr->m_next;
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        Iterator &operator--() noexcept {
+            curr = curr->m_prev;
+            return *this;
+        }
+
+        Iterator operator--(int) noexcept {
+            auto tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        reference operator*() const noexcept {
+            return *to_value(curr);
+        }
+
+        pointer operator->() const noexcept {
+            return to_value(curr);
+        }
+
+        bool operator==(Iterator const &that) const noexcept {
+            return curr == that.curr;
+        }
+
+        bool operator!=(Iterator const &that) const noexcept {
+            return curr != that.curr;
+        }
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    iterator begin() noexcept {
+        return iterator{m_dummy.m_next};
+    }
+
+    iterator end() noexcept {
+        return iterator{&m_dummy};
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator{m_dummy.m_next};
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator{&m_dummy};
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    // 从对象直接得到迭代器, O(1)
+    static iterator iterator_to(T &value) noexcept {
+        return iterator{to_hook(value)};
+    }
+
+    bool empty() const noexcept {
+        return m_dummy.m_next == &m_dummy;
+    }
+
+    // 钩子可以脱离链表自己unlink, 所以不缓存大小, size()是O(n)
+    size_t size() const noexcept {
+        size_t n = 0;
+        for (IntrusiveListHook const *p = m_dummy.m_next; p != &m_dummy; p = p->m_next)
+            ++n;
+        return n;
+    }
+
+    T &front() noexcept {
+        return *to_value(m_dummy.m_next);
+    }
+
+    T &back() noexcept {
+        return *to_value(m_dummy.m_prev);
+    }
+
+    T const &front() const noexcept {
+        return *to_value(m_dummy.m_next);
+    }
+
+    T const &back() const noexcept {
+        return *to_value(m_dummy.m_prev);
+    }
+
+    void push_front(T &value) noexcept {
+        to_hook(value)->link_before(m_dummy.m_next);
+    }
+
+    void push_back(T &value) noexcept {
+        to_hook(value)->link_before(&m_dummy);
+    }
+
+    // 插在pos前面, 返回指向value的迭代器
+    iterator insert(iterator pos, T &value) noexcept {
+        IntrusiveListHook *hook = to_hook(value);
+        hook->link_before(pos.curr);
+        return iterator{hook};
+    }
+
+    T &pop_front() noexcept {
+        T &value = front();
+        m_dummy.m_next->unlink();
+        return value;
+    }
+
+    T &pop_back() noexcept {
+        T &value = back();
+        m_dummy.m_prev->unlink();
+        return value;
+    }
+
+    // 返回下一个元素的迭代器
+    iterator erase(iterator pos) noexcept {
+        IntrusiveListHook *next = pos.curr->m_next;
+        pos.curr->unlink();
+        return iterator{next};
+    }
+
+    static void erase(T &value) noexcept {
+        to_hook(value)->unlink();
+    }
+
+    // 把value移到链表尾部, LRU的"最近使用"
+    void move_to_back(T &value) noexcept {
+        IntrusiveListHook *hook = to_hook(value);
+        if (hook->is_linked())
+            hook->unlink();
+        hook->link_before(&m_dummy);
+    }
+
+    void clear() noexcept {
+        IntrusiveListHook *p = m_dummy.m_next;
+        while (p != &m_dummy) {
+            IntrusiveListHook *next = p->m_next;
+            p->m_next = nullptr;
+            p->m_prev = nullptr;
+            p = next;
+        }
+        m_dummy.m_next = &m_dummy;
+        m_dummy.m_prev = &m_dummy;
+    }
+
+    // 把that的所有元素整体接到末尾, O(1)
+    void splice_back(IntrusiveList &that) noexcept {
+        if (that.empty())
+            return;
+        IntrusiveListHook *first = that.m_dummy.m_next;
+        IntrusiveListHook *last = that.m_dummy.m_prev;
+        first->m_prev = m_dummy.m_prev;
+        m_dummy.m_prev->m_next = first;
+        last->m_next = &m_dummy;
+        m_dummy.m_prev = last;
+        that.m_dummy.m_next = &that.m_dummy;
+        that.m_dummy.m_prev = &that.m_dummy;
+    }
+
+    void swap(IntrusiveList &that) noexcept {
+        // 哨兵的地址不能变, 所以要修正首尾节点指回哨兵的指针
+        bool this_empty = empty();
+        bool that_empty = that.empty();
+        std::swap(m_dummy.m_next, that.m_dummy.m_next);
+        std::swap(m_dummy.m_prev, that.m_dummy.m_prev);
+        if (that_empty) {
+            m_dummy.m_next = m_dummy.m_prev = &m_dummy;
+        } else {
+            m_dummy.m_next->m_prev = &m_dummy;
+            m_dummy.m_prev->m_next = &m_dummy;
+        }
+        if (this_empty) {
+            that.m_dummy.m_next = that.m_dummy.m_prev = &that.m_dummy;
+        } else {
+            that.m_dummy.m_next->m_prev = &that.m_dummy;
+            that.m_dummy.m_prev->m_next = &that.m_dummy;
+        }
+    }
+
+    template <class Visitor>
+    void foreach(Visitor visitor) {
+        for (IntrusiveListHook *p = m_dummy.m_next; p != &m_dummy;) {
+            IntrusiveListHook *next = p->m_next;
+            // 先记下next, 允许visitor把当前元素摘掉
+            visitor(*to_value(p));
+            p = next;
+        }
+    }
+};
@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Benchmark.hpp"
+#include "IntrusivePtr.hpp"
+#include "SharedPtr.hpp"
+
+struct Message : RefCounted<Message> {
+    std::string m_topic;
+    int m_seq;
+
+    Message(std::string topic, int seq) : m_topic(std::move(topic)), m_seq(seq) {}
+
+    ~Message() {
+        printf("~Message(%s, %d)\n", m_topic.c_str(), m_seq);
+    }
+};
+
+void test_ours() {
+    IntrusivePtr<Message> a = makeIntrusive<Message>("orders", 1);
+    IntrusivePtr<Message> b = a;
+    // 从裸指针再构造一个也没问题, 计数在对象里
+    IntrusivePtr<Message> c(b.get());
+    printf("use_count = %ld, sizeof(IntrusivePtr) = %zd\n", a.use_count(), sizeof(a));
+
+    // 还有别人持有时转不成UniquePtr, a保持原样
+    UniquePtr<Message> u = a.to_unique();
+    printf("to_unique while shared: %d, a still set: %d\n", u.get() != nullptr, (bool)a);
+    b.reset();
+    c.reset();
+    u = a.to_unique();
+    printf("to_unique when unique: %d, a empty: %d, seq = %d\n", u.get() != nullptr, !a, u->m_seq);
+    u->m_seq = 2;
+    // 再交回给IntrusivePtr, 计数从0重新开始
+    IntrusivePtr<Message> back(std::move(u));
+    printf("back use_count = %ld, seq = %d\n", back.use_count(), back->m_seq);
+    back = back;
+    printf("after self-assign use_count = %ld\n", back.use_count());
+}
+
+// 消息链表: 每个节点持有下一个节点, 节点在内存里的顺序是打乱的
+// 遍历时用持有所有权的游标往前走, 每一步拷贝一次指针(加计数)再析构旧游标(减计数)
+// 这正是转发消息时的访问模式: 读对象的同时改它的计数
+struct IntrusiveNode : RefCounted<IntrusiveNode> {
+    IntrusivePtr<IntrusiveNode> m_next;
+    uint64_t m_payload;
+};
+
+struct StdNode {
+    std::shared_ptr<StdNode> m_next;
+    uint64_t m_payload;
+};
+
+struct OurNode {
+    SharedPtr<OurNode> m_next;
+    uint64_t m_payload;
+};
+
+template <class Ptr, class Make>
+Ptr build_chain(Make make, size_t n) {
+    // 先按顺序分配, 再按随机顺序串起来, 这样相邻节点在内存里不相邻
+    std::vector<Ptr> nodes;
+    nodes.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        nodes.push_back(make());
+        nodes.back()->m_payload = i;
+    }
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+    for (size_t i = 0; i + 1 < n; i++)
+        nodes[order[i]]->m_next = nodes[order[i + 1]];
+    return nodes[order[0]];
+}
+
+// 链表很长, 逐个断开再析构, 避免析构函数递归把栈用完
+template <class Ptr>
+void destroy_chain(Ptr head) {
+    while (head) {
+        Ptr next = std::move(head->m_next);
+        head = std::move(next);
+    }
+}
+
+template <class Ptr, class Make>
+void bench_chase(char const *name, Make make, size_t n) {
+    Ptr head = build_chain<Ptr>(make, n);
+    benchmark(name, [&] {
+        uint64_t sum = 0;
+        for (Ptr p = head; p; p = p->m_next)
+            sum += p->m_payload;
+        doNotOptimize(sum);
+    }, n);
+    destroy_chain(std::move(head));
+}
+
+// 对照: 只读遍历, 游标用裸指针, 完全不碰计数
+template <class Ptr, class Make>
+void bench_chase_raw(char const *name, Make make, size_t n) {
+    Ptr head = build_chain<Ptr>(make, n);
+    benchmark(name, [&] {
+        uint64_t sum = 0;
+        for (auto *p = head.get(); p; p = p->m_next.get())
+            sum += p->m_payload;
+        doNotOptimize(sum);
+    }, n);
+    destroy_chain(std::move(head));
+}
+
+int main() {
+    test_ours();
+    // libstdc++的shared_ptr在没起过线程时不用原子指令, 先起一个线程让比较公平
+    std::thread([] {}).join();
+    size_t n = 1 << 20;
+    auto make_intrusive = [] { return makeIntrusive<IntrusiveNode>(); };
+    auto make_std = [] { return std::make_shared<StdNode>(); };
+    auto make_std_separate = [] { return std::shared_ptr<StdNode>(new StdNode()); };
+    auto make_ours = [] { return makeShared<OurNode>(); };
+    auto make_ours_separate = [] { return SharedPtr<OurNode>(new OurNode()); };
+    printf("== pointer chasing, %zd shuffled nodes, owning cursor ==\n", n);
+    bench_chase<IntrusivePtr<IntrusiveNode>>("IntrusivePtr", make_intrusive, n);
+    bench_chase<std::shared_ptr<StdNode>>("std::make_shared", make_std, n);
+    bench_chase<std::shared_ptr<StdNode>>("std::shared_ptr(new T)", make_std_separate, n);
+    bench_chase<SharedPtr<OurNode>>("makeShared", make_ours, n);
+    bench_chase<SharedPtr<OurNode>>("SharedPtr(new T)", make_ours_separate, n);
+    printf("== pointer chasing, raw cursor (no refcount traffic) ==\n");
+    bench_chase_raw<IntrusivePtr<IntrusiveNode>>("IntrusivePtr", make_intrusive, n);
+    bench_chase_raw<std::shared_ptr<StdNode>>("std::shared_ptr(new T)", make_std_separate, n);
+    return 0;
+}
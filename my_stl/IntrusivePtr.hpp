@@ -0,0 +1,183 @@
+#pragma once
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include "RefCount.hpp"
+#include "unique_ptr.hpp"
+
+// 侵入式引用计数: 计数直接嵌在对象里, 没有单独的控制块
+// 用法同cpp_home_work里Comp<T>的CRTP写法: struct Message : RefCounted<Message> { ... };
+// 访问对象和改计数落在同一块内存上, 顺着指针走一次只有一次cache miss, 指针本身也只有8字节
+// 代价是没有WeakPtr, 也不支持自定义删除器; 最后一个引用用delete释放对象
+// 释放时按RefCounted的模板参数Derived来delete: 对象的实际类型就是Derived时不需要虚析构函数,
+// 从Derived再派生出的类型(struct Sub : Message)要求Derived有虚析构函数, IntrusivePtr里有static_assert检查
+template <class Derived, class Policy = AtomicRefCount>
+struct RefCounted {
+private:
+    template <class T> friend struct IntrusivePtr;
+
+    using refcounted_type = Derived;
+
+    // 新对象计数为0, 交给第一个IntrusivePtr时才变成1
+    mutable typename Policy::Count m_refcount{0};
+
+    void intrusive_add_ref() const noexcept {
+        Policy::increment(m_refcount);
+    }
+
+    // CRTP: 转成Derived再delete, 对象的实际类型是Derived时不需要虚函数
+    void intrusive_release() const noexcept {
+        if (Policy::decrement(m_refcount))
+            delete static_cast<Derived const *>(this);
+    }
+
+    bool intrusive_is_unique() const noexcept {
+        return Policy::is_unique(m_refcount);
+    }
+
+    // 转给UniquePtr时清零, 之后还能再交给IntrusivePtr
+    void intrusive_detach() const noexcept {
+        m_refcount = 0;
+    }
+
+protected:
+    RefCounted() = default;
+
+    // 拷贝出来的是新对象, 计数不跟着拷贝
+    RefCounted(RefCounted const &) noexcept {}
+
+    RefCounted &operator=(RefCounted const &) noexcept {
+        return *this;
+    }
+
+    ~RefCounted() = default;
+
+public:
+    long use_count() const noexcept {
+        return Policy::load(m_refcount);
+    }
+};
+
+template <class T>
+struct IntrusivePtr {
+private:
+    template <class U> friend struct IntrusivePtr;
+
+    T *m_p = nullptr;
+
+    // 放在函数里而不是类里检查: IntrusivePtr<T>常作为T自己的成员, 类实例化时T还不完整
+    // Deleted是最终被delete的类型, 对象的实际类型是T
+    template <class Deleted>
+    static constexpr bool deletes_safely() noexcept {
+        return std::is_same_v<T, Deleted> || std::has_virtual_destructor_v<Deleted>;
+    }
+
+public:
+    IntrusivePtr(std::nullptr_t = nullptr) noexcept {}
+
+    // 裸指针可以来自new, 也可以来自别的IntrusivePtr的get(), 计数在对象里所以都是安全的
+    explicit IntrusivePtr(T *p) noexcept : m_p(p) {
+        static_assert(deletes_safely<typename T::refcounted_type>(),
+                      "a type derived from RefCounted<Base>'s Base needs a virtual destructor in Base");
+        if (m_p)
+            m_p->intrusive_add_ref();
+    }
+
+    // 从UniquePtr接管, 对象之前的计数必须是0
+    template <class U>
+    requires(std::convertible_to<U *, T *>)
+    IntrusivePtr(UniquePtr<U> &&that) noexcept : IntrusivePtr(static_cast<T *>(that.release())) {
+        static_assert(std::is_same_v<U, T> || std::has_virtual_destructor_v<T>,
+                      "converting UniquePtr<Derived> to IntrusivePtr<Base> requires a virtual destructor in Base");
+    }
+
+    IntrusivePtr(IntrusivePtr const &that) noexcept : IntrusivePtr(that.m_p) {}
+
+    IntrusivePtr(IntrusivePtr &&that) noexcept : m_p(std::exchange(that.m_p, nullptr)) {}
+
+    // 转成基类指针之后按基类释放, 基类要有虚析构函数
+    template <class U>
+    requires(std::convertible_to<U *, T *>)
+    IntrusivePtr(IntrusivePtr<U> const &that) noexcept : IntrusivePtr(static_cast<T *>(that.m_p)) {
+        static_assert(std::is_same_v<U, T> || std::has_virtual_destructor_v<T>,
+                      "converting IntrusivePtr<Derived> to IntrusivePtr<Base> requires a virtual destructor in Base");
+    }
+
+    template <class U>
+    requires(std::convertible_to<U *, T *>)
+    IntrusivePtr(IntrusivePtr<U> &&that) noexcept : m_p(std::exchange(that.m_p, nullptr)) {
+        static_assert(std::is_same_v<U, T> || std::has_virtual_destructor_v<T>,
+                      "converting IntrusivePtr<Derived> to IntrusivePtr<Base> requires a virtual destructor in Base");
+    }
+
+    ~IntrusivePtr() {
+        if (m_p)
+            m_p->intrusive_release();
+    }
+
+    // copy-and-swap: 先加新的再减旧的, 自赋值和"指向自己的成员"都不会提前释放
+    IntrusivePtr &operator=(IntrusivePtr const &that) noexcept {
+        IntrusivePtr(that).swap(*this);
+        return *this;
+    }
+
+    IntrusivePtr &operator=(IntrusivePtr &&that) noexcept {
+        IntrusivePtr(std::move(that)).swap(*this);
+        return *this;
+    }
+
+    void swap(IntrusivePtr &that) noexcept {
+        std::swap(m_p, that.m_p);
+    }
+
+    void reset(T *p = nullptr) noexcept {
+        IntrusivePtr(p).swap(*this);
+    }
+
+    T *get() const noexcept {
+        return m_p;
+    }
+
+    T &operator*() const noexcept {
+        return *m_p;
+    }
+
+    T *operator->() const noexcept {
+        return m_p;
+    }
+
+    explicit operator bool() const noexcept {
+        return m_p != nullptr;
+    }
+
+    long use_count() const noexcept {
+        return m_p ? m_p->use_count() : 0;
+    }
+
+    bool unique() const noexcept {
+        return m_p && m_p->intrusive_is_unique();
+    }
+
+    // 计数为1时把所有权转给UniquePtr, 自己变空; 否则返回空UniquePtr, 自己不变
+    // is_unique用acquire读, 保证看到其他持有者放手之前对对象的写
+    UniquePtr<T> to_unique() noexcept {
+        if (!unique())
+            return nullptr;
+        m_p->intrusive_detach();
+        return UniquePtr<T>(std::exchange(m_p, nullptr));
+    }
+
+    friend bool operator==(IntrusivePtr const &a, IntrusivePtr const &b) noexcept {
+        return a.m_p == b.m_p;
+    }
+
+    friend bool operator==(IntrusivePtr const &a, std::nullptr_t) noexcept {
+        return a.m_p == nullptr;
+    }
+};
+
+template <class T, class ...Args>
+IntrusivePtr<T> makeIntrusive(Args &&...args) {
+    return IntrusivePtr<T>(new T(std::forward<Args>(args)...));
+}
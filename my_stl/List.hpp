@@ -0,0 +1,609 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+// 节点拆成两部分: 只有指针的基类节点, 和带值的派生节点
+// 哨兵节点只需要基类部分, 不需要构造T
+struct ListBaseNode {
+    ListBaseNode *m_next;
+    ListBaseNode *m_prev;
+};
+
+template <class T>
+struct ListValueNode : ListBaseNode {
+    union {
+        T m_value;
+    };
+    // union不默认构造m_value, 由List手动construct_at/destroy_at
+
+    ListValueNode() noexcept {}
+    ~ListValueNode() noexcept {}
+};
+
+template <class T,class Alloc = std::allocator<T>>
+struct List {
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using pointer = T *;
+    using const_pointer = T const *;
+    using reference = T &;
+    using const_reference = T const &;
+
+    using ListNode = ListValueNode<T>;
+    using NodeAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<ListNode>;
+
+    ListBaseNode m_dummy;
+    size_t m_size;
+    [[no_unique_address]] NodeAlloc m_alloc;
+    // 循环链表，这样back可以实现为O(1)
+    // 原来用m_head指向第一个节点, begin()和end()无法区分
+    // 改为哨兵节点m_dummy: m_dummy.m_next是头, m_dummy.m_prev是尾, end()就是哨兵
+    // m_size缓存大小, size()为O(1)
+
+    List() noexcept {
+        init_empty();
+    }
+
+    explicit List(size_t n) : List() {
+        for (size_t i = 0; i < n; i++) {
+            emplace_back();
+        }
+    }
+
+    explicit List(size_t n, T const &val) : List() {
+        for (size_t i = 0; i < n; i++) {
+            emplace_back(val);
+        }
+    }
+
+    // C++20
+    /* template <class InputIt> */
+    /*     requires std::random_access_iterator<InputIt> */
+    template <std::input_iterator InputIt>
+    List(InputIt first, InputIt last) : List() {
+        while (first != last) {
+            emplace_back(*first);
+            ++first;
+        }
+    }
+    // 链表使用bidirectional_iterator, 构造时只用输入迭代器就可以了
+    // 如果想要使用it+n, 则使用std::advance(it, n);代替
+    // input_iterator = *it it++ ++it it!=it it==it
+    // output_iterator = *it=val it++ ++it it!=it it==it
+    // forward_iterator = *it *it=val it++ ++it it!=it it==it
+    // bidirectional_iterator = *it *it=val it++ ++it it-- --it it!=it it==it
+    // random_access_iterator = *it *it=val it[n] it[n]=val it++ ++it it-- --it it+=n it-=n it+n it-n it!=it it==it
+
+    List(std::initializer_list<T> ilist)
+    : List(ilist.begin(), ilist.end()) {}
+
+    List(List const &that) : List(that.begin(), that.end()) {}
+
+    List(List &&that) noexcept : List() {
+        swap(that);
+    }
+
+    List &operator=(List const &that) {
+        if (this != &that) [[likely]] {
+            List tmp(that);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    List &operator=(List &&that) noexcept {
+        if (this != &that) [[likely]] {
+            clear();
+            swap(that);
+        }
+        return *this;
+    }
+
+    ~List() noexcept {
+        clear();
+    }
+
+    template <class Visitor>
+    void foreach(Visitor visitor) {
+        for (ListBaseNode *curr = m_dummy.m_next; curr != &m_dummy; curr = curr->m_next) {
+            visitor(value_of(curr));
+        }
+    }
+
+    struct iterator {
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = ptrdiff_t;
+        using pointer = T *;
+        using reference = T &;
+
+        ListBaseNode *curr;
+
+        iterator &operator++() noexcept {
+            curr = curr->m_next;
+            return *this;
+        }
+
+        iterator operator++(int) noexcept {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        iterator &operator--() noexcept {
+            curr = curr->m_prev;
+            return *this;
+        }
+
+        iterator operator--(int) noexcept {
+            auto tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        T &operator*() const noexcept {
+            return value_of(curr);
+        }
+
+        T *operator->() const noexcept {
+            return std::addressof(value_of(curr));
+        }
+
+        bool operator!=(iterator const &that) const noexcept {
+            return curr != that.curr;
+        }
+
+        bool operator==(iterator const &that) const noexcept {
+            return !(*this != that);
+        }
+
+    };
+
+    struct const_iterator {
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = ptrdiff_t;
+        using pointer = T const *;
+        using reference = T const &;
+
+        ListBaseNode const *curr;
+
+        const_iterator() = default;
+        const_iterator(ListBaseNode const *p) noexcept : curr(p) {}
+        const_iterator(iterator that) noexcept : curr(that.curr) {}
+
+        const_iterator &operator++() noexcept {
+            curr = curr->m_next;
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        const_iterator &operator--() noexcept {
+            curr = curr->m_prev;
+            return *this;
+        }
+
+        const_iterator operator--(int) noexcept {
+            auto tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        T const &operator*() const noexcept {
+            return value_of(curr);
+        }
+
+        T const *operator->() const noexcept {
+            return std::addressof(value_of(curr));
+        }
+
+        bool operator!=(const_iterator const &that) const noexcept {
+            return curr != that.curr;
+        }
+
+        bool operator==(const_iterator const &that) const noexcept {
+            return !(*this != that);
+        }
+
+        // 修改链接时需要去掉const
+        ListBaseNode *node() const noexcept {
+            return const_cast<ListBaseNode *>(curr);
+        }
+    };
+
+    iterator begin() noexcept {
+        return iterator{m_dummy.m_next};
+    }
+
+    iterator end() noexcept {
+        return iterator{&m_dummy};
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator{m_dummy.m_next};
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator{&m_dummy};
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    bool empty() const noexcept {
+        return m_size == 0;
+    }
+
+    size_t size() const noexcept {
+        return m_size;
+    }
+
+    T &back() noexcept {
+        return value_of(m_dummy.m_prev);
+    }
+
+    T &front() noexcept {
+        return value_of(m_dummy.m_next);
+    }
+
+    T const &back() const noexcept {
+        return value_of(m_dummy.m_prev);
+    }
+
+    T const &front() const noexcept {
+        return value_of(m_dummy.m_next);
+    }
+
+    template <class ...Args>
+    iterator emplace(const_iterator pos, Args &&...args) {
+        ListNode *node = m_alloc.allocate(1);
+        std::construct_at(node);
+        try {
+            std::construct_at(&node->m_value, std::forward<Args>(args)...);
+        } catch (...) {
+            std::destroy_at(node);
+            m_alloc.deallocate(node, 1);
+            throw;
+        }
+        link_before(pos.node(), node);
+        ++m_size;
+        return iterator{node};
+    }
+
+    iterator insert(const_iterator pos, T const &val) {
+        return emplace(pos, val);
+    }
+
+    iterator insert(const_iterator pos, T &&val) {
+        return emplace(pos, std::move(val));
+    }
+
+    template <class ...Args>
+    T &emplace_back(Args &&...args) {
+        return *emplace(end(), std::forward<Args>(args)...);
+    }
+
+    template <class ...Args>
+    T &emplace_front(Args &&...args) {
+        return *emplace(begin(), std::forward<Args>(args)...);
+    }
+
+    void push_back(T const &val) {
+        emplace(end(), val);
+    }
+
+    void push_back(T &&val) {
+        emplace(end(), std::move(val));
+    }
+
+    void push_front(T const &val) {
+        emplace(begin(), val);
+    }
+
+    void push_front(T &&val) {
+        emplace(begin(), std::move(val));
+    }
+
+    // 返回被删除节点的下一个
+    iterator erase(const_iterator pos) noexcept {
+        ListBaseNode *node = pos.node();
+        ListBaseNode *next = node->m_next;
+        unlink(node);
+        --m_size;
+        destroy_node(node);
+        return iterator{next};
+    }
+
+    iterator erase(const_iterator first, const_iterator last) noexcept {
+        while (first != last) {
+            first = erase(first);
+        }
+        return iterator{last.node()};
+    }
+
+    void pop_back() noexcept {
+        erase(const_iterator{m_dummy.m_prev});
+    }
+
+    void pop_front() noexcept {
+        erase(const_iterator{m_dummy.m_next});
+    }
+
+    void clear() noexcept {
+        ListBaseNode *curr = m_dummy.m_next;
+        while (curr != &m_dummy) {
+            ListBaseNode *next = curr->m_next;
+            destroy_node(curr);
+            curr = next;
+        }
+        init_empty();
+    }
+
+    void swap(List &that) noexcept {
+        // 哨兵地址不能交换, 交换后修正首尾节点指回哨兵的指针
+        std::swap(m_dummy, that.m_dummy);
+        std::swap(m_size, that.m_size);
+        fix_dummy();
+        that.fix_dummy();
+    }
+
+    // splice只改指针, 不分配也不移动值; 节点必须来自同一种分配器
+    // 整个that接到pos前面
+    void splice(const_iterator pos, List &that) noexcept {
+        if (this == &that || that.empty())
+            return;
+        transfer(pos.node(), that.m_dummy.m_next, &that.m_dummy);
+        m_size += that.m_size;
+        that.m_size = 0;
+    }
+
+    void splice(const_iterator pos, List &&that) noexcept {
+        splice(pos, that);
+    }
+
+    // 把that中的单个节点it接到pos前面
+    void splice(const_iterator pos, List &that, const_iterator it) noexcept {
+        ListBaseNode *node = it.node();
+        if (node == pos.node() || node->m_next == pos.node())
+            return;
+        transfer(pos.node(), node, node->m_next);
+        --that.m_size;
+        ++m_size;
+    }
+
+    void splice(const_iterator pos, List &&that, const_iterator it) noexcept {
+        splice(pos, that, it);
+    }
+
+    // 把that中的[first, last)接到pos前面
+    // 同一个链表内是O(1); 不同链表之间要数出区间长度来维护m_size, 是O(n)
+    void splice(const_iterator pos, List &that, const_iterator first, const_iterator last) noexcept {
+        if (first == last)
+            return;
+        if (this != &that) {
+            size_t n = std::distance(first, last);
+            that.m_size -= n;
+            m_size += n;
+        }
+        transfer(pos.node(), first.node(), last.node());
+    }
+
+    void splice(const_iterator pos, List &&that, const_iterator first, const_iterator last) noexcept {
+        splice(pos, that, first, last);
+    }
+
+    // 两个有序链表归并, 稳定; that的节点全部转移到this, 不分配
+    template <class Compare>
+    void merge(List &that, Compare comp) {
+        if (this == &that)
+            return;
+        ListBaseNode *curr = m_dummy.m_next;
+        ListBaseNode *other = that.m_dummy.m_next;
+        while (curr != &m_dummy && other != &that.m_dummy) {
+            if (comp(value_of(other), value_of(curr))) {
+                ListBaseNode *next = other->m_next;
+                unlink(other);
+                link_before(curr, other);
+                other = next;
+            } else {
+                curr = curr->m_next;
+            }
+        }
+        if (other != &that.m_dummy)
+            transfer(&m_dummy, other, &that.m_dummy);
+        m_size += that.m_size;
+        that.m_size = 0;
+    }
+
+    void merge(List &that) {
+        merge(that, std::less<>());
+    }
+
+    void merge(List &&that) {
+        merge(that, std::less<>());
+    }
+
+    template <class Compare>
+    void merge(List &&that, Compare comp) {
+        merge(that, comp);
+    }
+
+    // 返回删除的个数
+    template <class Pred>
+    size_t remove_if(Pred pred) {
+        size_t old_size = m_size;
+        for (ListBaseNode *curr = m_dummy.m_next; curr != &m_dummy;) {
+            ListBaseNode *next = curr->m_next;
+            if (pred(value_of(curr))) {
+                unlink(curr);
+                --m_size;
+                destroy_node(curr);
+            }
+            curr = next;
+        }
+        return old_size - m_size;
+    }
+
+    // val可能就是链表里某个元素的引用(比如l.remove(l.front())), 同std::list:
+    // 持有val的那个节点先不删, 等比较完所有节点再删
+    size_t remove(T const &val) {
+        size_t old_size = m_size;
+        ListBaseNode *deferred = nullptr;
+        for (ListBaseNode *curr = m_dummy.m_next; curr != &m_dummy;) {
+            ListBaseNode *next = curr->m_next;
+            if (value_of(curr) == val) {
+                unlink(curr);
+                --m_size;
+                if (std::addressof(value_of(curr)) == std::addressof(val))
+                    deferred = curr;
+                else
+                    destroy_node(curr);
+            }
+            curr = next;
+        }
+        if (deferred)
+            destroy_node(deferred);
+        return old_size - m_size;
+    }
+
+    // 自底向上的归并排序, 只重新链接节点, 不移动值, 稳定
+    // 排序时把链表当单链表用(只维护m_next), 最后一次遍历补回m_prev
+    // bins[i]存放长度为2^i的有序段, 类似二进制加法进位
+    template <class Compare>
+    void sort(Compare comp) {
+        if (m_size < 2)
+            return;
+        ListBaseNode *bins[64] = {};
+        size_t max_bin = 0;
+        m_dummy.m_prev->m_next = nullptr;
+        ListBaseNode *curr = m_dummy.m_next;
+        while (curr != nullptr) {
+            ListBaseNode *next = curr->m_next;
+            curr->m_next = nullptr;
+            ListBaseNode *run = curr;
+            size_t i = 0;
+            for (; bins[i] != nullptr; i++) {
+                // bins[i]里的元素更靠前, 放在左边保证稳定
+                run = merge_runs(bins[i], run, comp);
+                bins[i] = nullptr;
+            }
+            bins[i] = run;
+            if (i > max_bin)
+                max_bin = i;
+            curr = next;
+        }
+        ListBaseNode *result = nullptr;
+        for (size_t i = 0; i <= max_bin; i++) {
+            if (bins[i] != nullptr)
+                result = merge_runs(bins[i], result, comp);
+        }
+        ListBaseNode *prev = &m_dummy;
+        for (curr = result; curr != nullptr; curr = curr->m_next) {
+            prev->m_next = curr;
+            curr->m_prev = prev;
+            prev = curr;
+        }
+        prev->m_next = &m_dummy;
+        m_dummy.m_prev = prev;
+    }
+
+    void sort() {
+        sort(std::less<>());
+    }
+
+    Alloc get_allocator() const noexcept {
+        return Alloc(m_alloc);
+    }
+
+private:
+    static T &value_of(ListBaseNode *node) noexcept {
+        return static_cast<ListNode *>(node)->m_value;
+    }
+
+    static T const &value_of(ListBaseNode const *node) noexcept {
+        return static_cast<ListNode const *>(node)->m_value;
+    }
+
+    void init_empty() noexcept {
+        m_dummy.m_next = &m_dummy;
+        m_dummy.m_prev = &m_dummy;
+        m_size = 0;
+    }
+
+    void fix_dummy() noexcept {
+        if (m_size == 0) {
+            m_dummy.m_next = &m_dummy;
+            m_dummy.m_prev = &m_dummy;
+        } else {
+            m_dummy.m_next->m_prev = &m_dummy;
+            m_dummy.m_prev->m_next = &m_dummy;
+        }
+    }
+
+    static void link_before(ListBaseNode *pos, ListBaseNode *node) noexcept {
+        node->m_next = pos;
+        node->m_prev = pos->m_prev;
+        pos->m_prev->m_next = node;
+        pos->m_prev = node;
+    }
+
+    static void unlink(ListBaseNode *node) noexcept {
+        node->m_prev->m_next = node->m_next;
+        node->m_next->m_prev = node->m_prev;
+    }
+
+    // 把[first, last)从原链表摘下, 接到pos前面
+    static void transfer(ListBaseNode *pos, ListBaseNode *first, ListBaseNode *last) noexcept {
+        if (pos == last)
+            return;
+        ListBaseNode *tail = last->m_prev;
+        first->m_prev->m_next = last;
+        last->m_prev = first->m_prev;
+        first->m_prev = pos->m_prev;
+        tail->m_next = pos;
+        pos->m_prev->m_next = first;
+        pos->m_prev = tail;
+    }
+
+    void destroy_node(ListBaseNode *node) noexcept {
+        ListNode *value_node = static_cast<ListNode *>(node);
+        std::destroy_at(&value_node->m_value);
+        std::destroy_at(value_node);
+        m_alloc.deallocate(value_node, 1);
+    }
+
+    // 合并两个以nullptr结尾的有序单链表
+    template <class Compare>
+    static ListBaseNode *merge_runs(ListBaseNode *a, ListBaseNode *b, Compare &comp) {
+        ListBaseNode head;
+        ListBaseNode *tail = &head;
+        while (a != nullptr && b != nullptr) {
+            if (comp(value_of(b), value_of(a))) {
+                tail->m_next = b;
+                b = b->m_next;
+            } else {
+                tail->m_next = a;
+                a = a->m_next;
+            }
+            tail = tail->m_next;
+        }
+        tail->m_next = a != nullptr ? a : b;
+        return head.m_next;
+    }
+};
@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Benchmark.hpp"
+#include "LruCache.hpp"
+
+// 对照组: 常见的std::list + std::unordered_map写法, 每个条目分配两次
+template <class K, class V>
+struct StdLruCache {
+    size_t m_capacity;
+    std::list<std::pair<K, V>> m_list;
+    std::unordered_map<K, typename std::list<std::pair<K, V>>::iterator> m_map;
+
+    explicit StdLruCache(size_t capacity) : m_capacity(capacity) {}
+
+    V *get(K const &key) {
+        auto it = m_map.find(key);
+        if (it == m_map.end())
+            return nullptr;
+        m_list.splice(m_list.end(), m_list, it->second);
+        return &it->second->second;
+    }
+
+    bool put(K const &key, V const &value) {
+        auto it = m_map.find(key);
+        if (it != m_map.end()) {
+            it->second->second = value;
+            m_list.splice(m_list.end(), m_list, it->second);
+            return false;
+        }
+        if (m_map.size() == m_capacity) {
+            m_map.erase(m_list.front().first);
+            m_list.pop_front();
+        }
+        m_list.emplace_back(key, value);
+        m_map.emplace(key, std::prev(m_list.end()));
+        return true;
+    }
+};
+
+// 长度为n的Zipf(s)访问序列, 先生成好, 不把随机数的开销算进去
+std::vector<uint64_t> zipf_trace(size_t keys, size_t n, double s, uint32_t seed) {
+    std::vector<double> cdf(keys);
+    double sum = 0;
+    for (size_t i = 0; i < keys; i++) {
+        sum += 1.0 / std::pow((double)(i + 1), s);
+        cdf[i] = sum;
+    }
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> dist(0, sum);
+    std::vector<uint64_t> trace(n);
+    for (size_t i = 0; i < n; i++)
+        trace[i] = std::lower_bound(cdf.begin(), cdf.end(), dist(rng)) - cdf.begin();
+    return trace;
+}
+
+// 每隔一段插入一次冷数据的顺序扫描, 普通LRU会被冲掉热点
+std::vector<uint64_t> scan_trace(size_t keys, size_t n, uint32_t seed) {
+    std::vector<uint64_t> trace = zipf_trace(keys, n, 0.99, seed);
+    uint64_t cold = keys;
+    for (size_t i = 0; i < n; i += 4096) {
+        for (size_t j = i; j < std::min(n, i + 1024); j++)
+            trace[j] = cold++;
+    }
+    return trace;
+}
+
+// 读穿透: 未命中就put, 返回命中率
+template <class Cache>
+double run_trace(Cache &cache, std::vector<uint64_t> const &trace) {
+    size_t hits = 0;
+    for (uint64_t key: trace) {
+        if (uint64_t *value = cache.get(key)) {
+            ++hits;
+            doNotOptimize(*value);
+        } else {
+            cache.put(key, key * 2);
+        }
+    }
+    return (double)hits / trace.size();
+}
+
+void test_ours() {
+    LruCache<std::string, int> cache(3);
+    cache.put("a", 1);
+    cache.put("b", 2);
+    cache.put("c", 3);
+    cache.get("a");
+    cache.put("d", 4);
+    // b最久未使用, 被淘汰
+    cache.foreach([] (std::string const &key, int &value) {
+        printf("%s = %d\n", key.c_str(), value);
+    });
+    printf("contains b: %d, size: %zd\n", cache.contains("b"), cache.size());
+
+    // 按字节数限制, 每个条目的大小由weigher给出
+    struct StringWeigher {
+        size_t operator()(int const &, std::string const &value) const noexcept {
+            return value.size();
+        }
+    };
+    LruCache<int, std::string, std::hash<int>, std::equal_to<int>, StringWeigher> bytes_cache(100, LruMode::Plain, 16);
+    bytes_cache.put(1, std::string(8, 'x'));
+    bytes_cache.put(2, std::string(8, 'y'));
+    bytes_cache.put(3, std::string(4, 'z'));
+    printf("bytes: %zd, size: %zd, contains 1: %d\n", bytes_cache.bytes(), bytes_cache.size(), bytes_cache.contains(1));
+
+    ShardedLruCache<int, int> sharded(64);
+    sharded.put(1, 10);
+    Optional<int> value = sharded.get(1);
+    printf("sharded get(1): %d, get(2) has_value: %d\n", value.value(), sharded.get(2).has_value());
+}
+
+template <class Cache>
+void bench_one(char const *name, Cache &cache, std::vector<uint64_t> const &trace) {
+    double hit_rate = 0;
+    benchmark(name, [&] {
+        hit_rate = run_trace(cache, trace);
+    }, trace.size());
+    printf("%-40s hit rate %.2f%%\n", "", hit_rate * 100);
+}
+
+void bench_single(char const *title, std::vector<uint64_t> const &trace, size_t capacity) {
+    printf("== %s ==\n", title);
+    StdLruCache<uint64_t, uint64_t> std_lru(capacity);
+    LruCache<uint64_t, uint64_t> lru(capacity);
+    LruCache<uint64_t, uint64_t> slru(capacity, LruMode::Segmented);
+    bench_one("std::list + unordered_map LRU", std_lru, trace);
+    bench_one("LruCache (Plain)", lru, trace);
+    bench_one("LruCache (Segmented)", slru, trace);
+}
+
+// 一把大锁保护的LruCache, 作为分片版本的对照
+struct LockedLruCache {
+    std::mutex m_mutex;
+    LruCache<uint64_t, uint64_t> m_cache;
+
+    explicit LockedLruCache(size_t capacity) : m_cache(capacity) {}
+
+    Optional<uint64_t> get(uint64_t key) {
+        std::lock_guard lock(m_mutex);
+        uint64_t *value = m_cache.get(key);
+        if (value == nullptr)
+            return Nullopt;
+        return Optional<uint64_t>(*value);
+    }
+
+    void put(uint64_t key, uint64_t value) {
+        std::lock_guard lock(m_mutex);
+        m_cache.put(key, value);
+    }
+};
+
+template <class Cache>
+void run_threads(char const *name, Cache &cache, std::vector<std::vector<uint64_t>> const &traces) {
+    size_t total = 0;
+    for (auto const &trace: traces)
+        total += trace.size();
+    benchmark(name, [&] {
+        std::vector<std::thread> threads;
+        for (auto const &trace: traces) {
+            threads.emplace_back([&cache, &trace] {
+                for (uint64_t key: trace) {
+                    Optional<uint64_t> value = cache.get(key);
+                    if (!value)
+                        cache.put(key, key * 2);
+                    doNotOptimize(value);
+                }
+            });
+        }
+        for (auto &t: threads)
+            t.join();
+    }, total);
+}
+
+void bench_sharded(size_t keys, size_t capacity, size_t ops) {
+    printf("== concurrent get/put, Zipf(0.99) ==\n");
+    for (size_t nthreads: {1, 2, 4, 8}) {
+        std::vector<std::vector<uint64_t>> traces;
+        for (size_t i = 0; i < nthreads; i++)
+            traces.push_back(zipf_trace(keys, ops / nthreads, 0.99, (uint32_t)i + 1));
+        LockedLruCache locked(capacity);
+        ShardedLruCache<uint64_t, uint64_t> sharded(capacity);
+        char name[64];
+        snprintf(name, sizeof name, "single mutex, %zd threads", nthreads);
+        run_threads(name, locked, traces);
+        snprintf(name, sizeof name, "ShardedLruCache<16>, %zd threads", nthreads);
+        run_threads(name, sharded, traces);
+    }
+}
+
+int main() {
+    test_ours();
+    size_t keys = 1 << 20;
+    size_t ops = 1 << 22;
+    size_t capacity = keys / 10;
+    bench_single("Zipf(0.99)", zipf_trace(keys, ops, 0.99, 42), capacity);
+    bench_single("Zipf(0.99) + sequential scans", scan_trace(keys, ops, 42), capacity);
+    bench_sharded(keys, capacity, ops);
+    return 0;
+}
@@ -0,0 +1,398 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include "IntrusiveList.hpp"
+#include "Optional.hpp"
+
+// 每个条目的字节数, 默认只算K和V本身; 带堆内存的类型可以自己传一个
+template <class K, class V>
+struct LruDefaultWeigher {
+    size_t operator()(K const &, V const &) const noexcept {
+        return sizeof(K) + sizeof(V);
+    }
+};
+
+enum class LruMode {
+    Plain,      // 普通LRU
+    Segmented,  // SLRU: 新条目进试用段, 再次命中才晋升到保护段, 扫描式访问冲不掉热点
+};
+
+// std::list + std::unordered_map 的LRU每个条目要分配两次
+// 这里条目放在一次性分配好的槽位池里, 用IntrusiveList(List的循环双链表)维护新旧顺序
+// 索引是开放寻址的平坦数组, 存槽位下标和哈希, 查找时基本不用碰槽位本身
+template <class K, class V, class Hash = std::hash<K>, class KeyEqual = std::equal_to<K>,
+          class Weigher = LruDefaultWeigher<K, V>>
+struct LruCache {
+    using key_type = K;
+    using mapped_type = V;
+    using size_type = size_t;
+
+private:
+    struct Slot {
+        IntrusiveListHook m_hook;
+        uint32_t m_hash;
+        bool m_protected;
+        size_t m_bytes;
+        union {
+            K m_key;
+        };
+        union {
+            V m_value;
+        };
+        // union让空闲槽位不需要构造K和V
+
+        Slot() noexcept {}
+        ~Slot() noexcept {}
+    };
+
+    using SlotList = IntrusiveList<Slot, &Slot::m_hook>;
+
+    // 索引桶: 槽位下标+1(0表示空桶) 和 32位哈希
+    struct Bucket {
+        uint32_t m_slot;
+        uint32_t m_hash;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    std::unique_ptr<uint32_t[]> m_free;
+    std::unique_ptr<Bucket[]> m_buckets;
+    size_t m_capacity;
+    size_t m_free_count;
+    size_t m_mask;
+    size_t m_size;
+    size_t m_bytes;
+    size_t m_max_bytes;
+    size_t m_protected_count;
+    size_t m_protected_capacity;
+    LruMode m_mode;
+    SlotList m_probation;
+    SlotList m_protected;
+    // 链表要在槽位池之前析构, 所以声明在后面
+    // Plain模式下只用m_probation, 表头是最久未使用的
+    [[no_unique_address]] Hash m_hash;
+    [[no_unique_address]] KeyEqual m_equal;
+    [[no_unique_address]] Weigher m_weigher;
+
+public:
+    // capacity: 最多条目数; max_bytes: 条目总字节上限, 0表示不限
+    explicit LruCache(size_t capacity, LruMode mode = LruMode::Plain, size_t max_bytes = 0)
+    : m_capacity(capacity), m_free_count(capacity), m_size(0), m_bytes(0),
+      m_max_bytes(max_bytes), m_protected_count(0), m_mode(mode) {
+        if (capacity == 0 || capacity >= UINT32_MAX) [[unlikely]]
+            throw std::invalid_argument("LruCache: bad capacity");
+        m_slots = std::make_unique<Slot[]>(capacity);
+        m_free = std::make_unique_for_overwrite<uint32_t[]>(capacity);
+        for (size_t i = 0; i != capacity; i++)
+            m_free[i] = (uint32_t)(capacity - 1 - i);
+        // 负载因子不超过0.5, 线性探测的探测长度很短
+        size_t buckets = 1;
+        while (buckets < capacity * 2)
+            buckets *= 2;
+        m_buckets = std::make_unique<Bucket[]>(buckets);
+        m_mask = buckets - 1;
+        // 保护段占80%, 与常见的SLRU配置一致
+        m_protected_capacity = mode == LruMode::Segmented ? capacity * 4 / 5 : 0;
+    }
+
+    LruCache(LruCache const &) = delete;
+    LruCache &operator=(LruCache const &) = delete;
+
+    ~LruCache() noexcept {
+        clear();
+    }
+
+    size_t size() const noexcept {
+        return m_size;
+    }
+
+    size_t capacity() const noexcept {
+        return m_capacity;
+    }
+
+    size_t bytes() const noexcept {
+        return m_bytes;
+    }
+
+    bool empty() const noexcept {
+        return m_size == 0;
+    }
+
+    // 命中时标记为最近使用, 返回值的指针; 未命中返回nullptr
+    // 指针在下一次put/erase之前有效
+    V *get(K const &key) {
+        uint32_t h = hash_of(key);
+        size_t b = find_bucket(key, h);
+        if (b == npos)
+            return nullptr;
+        Slot &slot = m_slots[m_buckets[b].m_slot - 1];
+        touch(slot);
+        return &slot.m_value;
+    }
+
+    // 只查不改变新旧顺序
+    V const *peek(K const &key) const {
+        uint32_t h = hash_of(key);
+        size_t b = find_bucket(key, h);
+        if (b == npos)
+            return nullptr;
+        return &m_slots[m_buckets[b].m_slot - 1].m_value;
+    }
+
+    bool contains(K const &key) const {
+        return find_bucket(key, hash_of(key)) != npos;
+    }
+
+    // 插入或更新, 返回是否新插入; 超出条目数或字节数时淘汰最久未使用的
+    template <class KK, class VV>
+    bool put(KK &&key, VV &&value) {
+        uint32_t h = hash_of(key);
+        size_t b = find_bucket(key, h);
+        if (b != npos) {
+            Slot &slot = m_slots[m_buckets[b].m_slot - 1];
+            slot.m_value = std::forward<VV>(value);
+            m_bytes -= slot.m_bytes;
+            slot.m_bytes = m_weigher(slot.m_key, slot.m_value);
+            m_bytes += slot.m_bytes;
+            touch(slot);
+            evict_over_budget(&slot);
+            return false;
+        }
+        if (m_free_count == 0)
+            evict_one();
+        uint32_t idx = m_free[--m_free_count];
+        Slot &slot = m_slots[idx];
+        try {
+            std::construct_at(&slot.m_key, std::forward<KK>(key));
+            try {
+                std::construct_at(&slot.m_value, std::forward<VV>(value));
+            } catch (...) {
+                std::destroy_at(&slot.m_key);
+                throw;
+            }
+        } catch (...) {
+            m_free[m_free_count++] = idx;
+            throw;
+        }
+        slot.m_hash = h;
+        slot.m_protected = false;
+        slot.m_bytes = m_weigher(slot.m_key, slot.m_value);
+        m_bytes += slot.m_bytes;
+        m_probation.push_back(slot);
+        insert_bucket(idx, h);
+        ++m_size;
+        evict_over_budget(&slot);
+        return true;
+    }
+
+    bool erase(K const &key) {
+        size_t b = find_bucket(key, hash_of(key));
+        if (b == npos)
+            return false;
+        uint32_t idx = m_buckets[b].m_slot - 1;
+        erase_bucket(b);
+        release_slot(idx);
+        return true;
+    }
+
+    void clear() noexcept {
+        while (!m_probation.empty())
+            release_slot(m_probation.front());
+        while (!m_protected.empty())
+            release_slot(m_protected.front());
+        for (size_t i = 0; i <= m_mask; i++)
+            m_buckets[i].m_slot = 0;
+    }
+
+    // 从最近使用到最久未使用遍历(保护段在前)
+    template <class Visitor>
+    void foreach(Visitor visitor) {
+        for (auto it = m_protected.end(); it != m_protected.begin();) {
+            --it;
+            visitor(std::as_const(it->m_key), it->m_value);
+        }
+        for (auto it = m_probation.end(); it != m_probation.begin();) {
+            --it;
+            visitor(std::as_const(it->m_key), it->m_value);
+        }
+    }
+
+private:
+    static constexpr size_t npos = (size_t)-1;
+
+    uint32_t hash_of(K const &key) const {
+        // std::hash<int>是恒等映射, 必须再混合一次, 否则线性探测会聚集
+        uint64_t h = (uint64_t)m_hash(key);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return (uint32_t)h;
+    }
+
+    size_t find_bucket(K const &key, uint32_t h) const {
+        for (size_t b = h & m_mask;; b = (b + 1) & m_mask) {
+            Bucket const &bucket = m_buckets[b];
+            if (bucket.m_slot == 0)
+                return npos;
+            if (bucket.m_hash == h && m_equal(m_slots[bucket.m_slot - 1].m_key, key))
+                return b;
+        }
+    }
+
+    void insert_bucket(uint32_t idx, uint32_t h) noexcept {
+        size_t b = h & m_mask;
+        while (m_buckets[b].m_slot != 0)
+            b = (b + 1) & m_mask;
+        m_buckets[b] = Bucket{idx + 1, h};
+    }
+
+    // 向后平移删除(backward shift), 不留墓碑, 探测链始终保持紧凑
+    void erase_bucket(size_t b) noexcept {
+        size_t hole = b;
+        for (size_t j = (b + 1) & m_mask; m_buckets[j].m_slot != 0; j = (j + 1) & m_mask) {
+            size_t home = m_buckets[j].m_hash & m_mask;
+            // home不在(hole, j]之间, 说明j可以挪到hole
+            bool movable = hole <= j ? (home <= hole || home > j) : (home <= hole && home > j);
+            if (movable) {
+                m_buckets[hole] = m_buckets[j];
+                hole = j;
+            }
+        }
+        m_buckets[hole].m_slot = 0;
+    }
+
+    void touch(Slot &slot) noexcept {
+        if (m_mode == LruMode::Plain) {
+            m_probation.move_to_back(slot);
+            return;
+        }
+        if (slot.m_protected) {
+            m_protected.move_to_back(slot);
+            return;
+        }
+        // 试用段再次命中, 晋升到保护段; 保护段满了就把最旧的降级回试用段
+        SlotList::erase(slot);
+        slot.m_protected = true;
+        m_protected.push_back(slot);
+        if (++m_protected_count > m_protected_capacity) {
+            Slot &demoted = m_protected.pop_front();
+            demoted.m_protected = false;
+            --m_protected_count;
+            m_probation.push_back(demoted);
+        }
+    }
+
+    void evict_one() noexcept {
+        Slot &victim = m_probation.empty() ? m_protected.front() : m_probation.front();
+        size_t b = find_bucket(victim.m_key, victim.m_hash);
+        erase_bucket(b);
+        release_slot(victim);
+    }
+
+    void evict_over_budget(Slot *keep) noexcept {
+        if (m_max_bytes == 0)
+            return;
+        while (m_bytes > m_max_bytes && m_size > 1) {
+            // 不淘汰刚写入的条目
+            Slot *victim = m_probation.empty() ? &m_protected.front() : &m_probation.front();
+            if (victim == keep) {
+                // keep刚放到链表尾部, 它在表头说明这一段只剩它自己
+                if (victim->m_protected || m_protected.empty())
+                    break;
+                victim = &m_protected.front();
+            }
+            erase_bucket(find_bucket(victim->m_key, victim->m_hash));
+            release_slot(*victim);
+        }
+    }
+
+    void release_slot(uint32_t idx) noexcept {
+        release_slot(m_slots[idx]);
+    }
+
+    // 调用前要先删掉索引桶
+    void release_slot(Slot &slot) noexcept {
+        SlotList::erase(slot);
+        if (slot.m_protected)
+            --m_protected_count;
+        m_bytes -= slot.m_bytes;
+        std::destroy_at(&slot.m_value);
+        std::destroy_at(&slot.m_key);
+        --m_size;
+        m_free[m_free_count++] = (uint32_t)(&slot - m_slots.get());
+    }
+};
+
+// 分片版本: 按哈希把key分到Shards个互相独立的LruCache, 每片一把锁
+// 每片按cache line对齐, 避免不同片的锁之间伪共享
+template <class K, class V, size_t Shards = 16, class Hash = std::hash<K>,
+          class KeyEqual = std::equal_to<K>, class Weigher = LruDefaultWeigher<K, V>>
+struct ShardedLruCache {
+    static_assert((Shards & (Shards - 1)) == 0, "Shards must be a power of two");
+
+private:
+    struct alignas(64) Shard {
+        std::mutex m_mutex;
+        LruCache<K, V, Hash, KeyEqual, Weigher> m_cache;
+
+        Shard(size_t capacity, LruMode mode, size_t max_bytes)
+        : m_cache(capacity, mode, max_bytes) {}
+    };
+
+    std::unique_ptr<Shard> m_shards[Shards];
+    [[no_unique_address]] Hash m_hash;
+
+    Shard &shard_of(K const &key) {
+        // 用哈希的高位选片, 低位留给片内的索引
+        uint64_t h = (uint64_t)m_hash(key) * 0x9e3779b97f4a7c15ULL;
+        return *m_shards[h >> 32 & (Shards - 1)];
+    }
+
+public:
+    // capacity和max_bytes是总量, 平均分到每一片
+    explicit ShardedLruCache(size_t capacity, LruMode mode = LruMode::Plain, size_t max_bytes = 0) {
+        size_t per_shard = (capacity + Shards - 1) / Shards;
+        size_t bytes_per_shard = (max_bytes + Shards - 1) / Shards;
+        for (size_t i = 0; i != Shards; i++)
+            m_shards[i] = std::make_unique<Shard>(per_shard, mode, bytes_per_shard);
+    }
+
+    ShardedLruCache(ShardedLruCache const &) = delete;
+    ShardedLruCache &operator=(ShardedLruCache const &) = delete;
+
+    // 锁外不能持有指针, 所以返回值的拷贝
+    Optional<V> get(K const &key) {
+        Shard &shard = shard_of(key);
+        std::lock_guard lock(shard.m_mutex);
+        V *value = shard.m_cache.get(key);
+        if (value == nullptr)
+            return Nullopt;
+        return Optional<V>(*value);
+    }
+
+    template <class KK, class VV>
+    bool put(KK &&key, VV &&value) {
+        Shard &shard = shard_of(key);
+        std::lock_guard lock(shard.m_mutex);
+        return shard.m_cache.put(std::forward<KK>(key), std::forward<VV>(value));
+    }
+
+    bool erase(K const &key) {
+        Shard &shard = shard_of(key);
+        std::lock_guard lock(shard.m_mutex);
+        return shard.m_cache.erase(key);
+    }
+
+    size_t size() {
+        size_t n = 0;
+        for (size_t i = 0; i != Shards; i++) {
+            std::lock_guard lock(m_shards[i]->m_mutex);
+            n += m_shards[i]->m_cache.size();
+        }
+        return n;
+    }
+};
@@ -0,0 +1,137 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Benchmark.hpp"
+#include "List.hpp"
+#include "MpscQueue.hpp"
+
+struct Work {
+    MpscQueueHook m_hook;
+    uint64_t m_producer;
+    uint64_t m_seq;
+};
+
+using WorkQueue = MpscQueue<Work, &Work::m_hook>;
+
+// 对照组: 互斥锁保护的List, 每次push都要分配一个节点
+struct LockedList {
+    std::mutex m_mutex;
+    List<Work *> m_list;
+
+    void push(Work &work) {
+        std::lock_guard lock(m_mutex);
+        m_list.push_back(&work);
+    }
+
+    Work *pop() {
+        std::lock_guard lock(m_mutex);
+        if (m_list.empty())
+            return nullptr;
+        Work *work = m_list.front();
+        m_list.pop_front();
+        return work;
+    }
+};
+
+void test_ours() {
+    WorkQueue queue;
+    Work works[4];
+    for (uint64_t i = 0; i < 4; i++) {
+        works[i].m_seq = i;
+        queue.push(works[i]);
+    }
+    Work *first = queue.pop();
+    printf("pop: %lu\n", (unsigned long)first->m_seq);
+    size_t n = queue.pop_all([] (Work &work) {
+        printf("pop_all: %lu\n", (unsigned long)work.m_seq);
+    });
+    printf("drained %zd, empty: %d\n", n, queue.empty());
+    queue.push(works[0]);
+    printf("pop again: %lu\n", (unsigned long)queue.pop()->m_seq);
+
+    // visitor每处理一个就推回去一个, 相当于生产者一直在推: pop_all只取走调用时已有的
+    for (uint64_t i = 0; i < 4; i++)
+        queue.push(works[i]);
+    for (int round = 0; round < 2; round++) {
+        n = queue.pop_all([&] (Work &work) {
+            printf("requeue: %lu\n", (unsigned long)work.m_seq);
+            queue.push(work);
+        });
+        printf("round %d drained %zd\n", round, n);
+    }
+    queue.pop_all([] (Work &) {});
+}
+
+// 每个生产者按顺序推送自己的元素, 消费者检查每个生产者的序号是否递增
+template <class Queue, class Drain>
+void bench_queue(char const *name, size_t producers, size_t per_producer, Drain drain) {
+    Queue queue;
+    std::vector<std::unique_ptr<Work[]>> works;
+    for (size_t p = 0; p < producers; p++) {
+        works.push_back(std::make_unique<Work[]>(per_producer));
+        for (size_t i = 0; i < per_producer; i++) {
+            works[p][i].m_producer = p;
+            works[p][i].m_seq = i;
+        }
+    }
+    size_t total = producers * per_producer;
+    bool ordered = true;
+    benchmark(name, [&] {
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < producers; p++) {
+            threads.emplace_back([&, p] {
+                for (size_t i = 0; i < per_producer; i++)
+                    queue.push(works[p][i]);
+            });
+        }
+        std::vector<uint64_t> expect(producers, 0);
+        size_t received = 0;
+        while (received < total) {
+            size_t n = drain(queue, [&] (Work &work) {
+                if (work.m_seq != expect[work.m_producer]++)
+                    ordered = false;
+            });
+            if (n == 0)
+                std::this_thread::yield();
+            received += n;
+        }
+        for (auto &t: threads)
+            t.join();
+    }, total);
+    if (!ordered)
+        printf("%s: FIFO order violated!\n", name);
+}
+
+int main() {
+    test_ours();
+    size_t per_producer = 1 << 20;
+    auto drain_mpsc = [] (WorkQueue &queue, auto visitor) {
+        return queue.pop_all(visitor);
+    };
+    auto drain_one_by_one = [] (WorkQueue &queue, auto visitor) {
+        Work *work = queue.pop();
+        if (work == nullptr)
+            return 0;
+        visitor(*work);
+        return 1;
+    };
+    auto drain_locked = [] (LockedList &queue, auto visitor) {
+        size_t n = 0;
+        while (Work *work = queue.pop()) {
+            visitor(*work);
+            ++n;
+        }
+        return n;
+    };
+    for (size_t producers: {1, 2, 4, 8}) {
+        printf("== %zd producers ==\n", producers);
+        bench_queue<WorkQueue>("MpscQueue pop_all", producers, per_producer / producers, drain_mpsc);
+        bench_queue<WorkQueue>("MpscQueue pop", producers, per_producer / producers, drain_one_by_one);
+        bench_queue<LockedList>("std::mutex + List", producers, per_producer / producers, drain_locked);
+    }
+    return 0;
+}
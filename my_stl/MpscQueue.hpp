@@ -0,0 +1,119 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "ContainerOf.hpp"
+
+// Vyukov的侵入式多生产者单消费者(MPSC)队列
+// 思路同List的节点链接, 只是next换成了原子指针, 并且只需要单向链接:
+// 生产者只做一次exchange把自己挂到队尾, 再把前一个节点的next指向自己, 没有循环, 是wait-free的
+// 消费者独占队头, 不需要任何原子读改写
+
+struct MpscQueueHook {
+    std::atomic<MpscQueueHook *> m_next{nullptr};
+};
+
+template <class T, MpscQueueHook T::*Hook>
+struct MpscQueue {
+    using value_type = T;
+
+    MpscQueue() noexcept : m_back(&m_stub), m_front(&m_stub) {}
+
+    MpscQueue(MpscQueue const &) = delete;
+    MpscQueue &operator=(MpscQueue const &) = delete;
+
+    // 任意线程都可以调用, wait-free
+    void push(T &value) noexcept {
+        push_hook(&(value.*Hook));
+    }
+
+    // 只能由消费者线程调用
+    // 队列为空, 或者某个生产者exchange之后还没来得及链接next时返回nullptr
+    T *pop() noexcept {
+        MpscQueueHook *front = m_front;
+        MpscQueueHook *next = front->m_next.load(std::memory_order_acquire);
+        if (front == &m_stub) {
+            // 跳过哨兵
+            if (next == nullptr)
+                return nullptr;
+            m_front = next;
+            front = next;
+            next = next->m_next.load(std::memory_order_acquire);
+        }
+        if (next != nullptr) {
+            m_front = next;
+            return to_value(front);
+        }
+        // front是最后一个节点: 如果还有生产者在途, 下次再来
+        if (front != m_back.load(std::memory_order_acquire))
+            return nullptr;
+        // 重新挂上哨兵, 这样front就有了后继, 可以摘下来
+        push_hook(&m_stub);
+        next = front->m_next.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            m_front = next;
+            return to_value(front);
+        }
+        return nullptr;
+    }
+
+    // 只能由消费者线程调用, 一次取走调用时已经在队列里的元素, 返回个数
+    // 开始时读一次m_back作为终点, 之后只沿next前进, 生产者一直在推也会返回;
+    // 终点之后新推进来的(包括visitor里重新推回来的)留给下一次
+    // 只有终点那个元素要像pop一样重新挂哨兵才能摘下
+    template <class Visitor>
+    size_t pop_all(Visitor visitor) {
+        MpscQueueHook *back = m_back.load(std::memory_order_acquire);
+        MpscQueueHook *front = m_front;
+        size_t n = 0;
+        for (;;) {
+            MpscQueueHook *next = front->m_next.load(std::memory_order_acquire);
+            if (front == &m_stub) {
+                if (next == nullptr || front == back)
+                    break;
+                m_front = front = next;
+                continue;
+            }
+            // 到了终点, 或者生产者exchange之后还没链接next
+            if (front == back || next == nullptr)
+                break;
+            // 先前进再调用visitor, visitor可以把元素重新推回队列
+            m_front = next;
+            visitor(*to_value(front));
+            ++n;
+            front = next;
+        }
+        if (front == back && front != &m_stub) {
+            if (T *value = pop()) {
+                visitor(*value);
+                ++n;
+            }
+        }
+        return n;
+    }
+
+    // 只是一个快照, 并发时仅供参考
+    bool empty() const noexcept {
+        MpscQueueHook const *front = m_front;
+        if (front == &m_stub)
+            return front->m_next.load(std::memory_order_acquire) == nullptr;
+        return false;
+    }
+
+private:
+    void push_hook(MpscQueueHook *hook) noexcept {
+        hook->m_next.store(nullptr, std::memory_order_relaxed);
+        MpscQueueHook *prev = m_back.exchange(hook, std::memory_order_acq_rel);
+        // exchange与这一句之间, 链表是"断开"的, 消费者会看到next为空
+        prev->m_next.store(hook, std::memory_order_release);
+    }
+
+    static T *to_value(MpscQueueHook *hook) noexcept {
+        return container_of(hook, Hook);
+    }
+
+    // 生产者和消费者各自写的变量放在不同的cache line, 避免伪共享
+    alignas(64) std::atomic<MpscQueueHook *> m_back;
+    alignas(64) MpscQueueHook *m_front;
+    MpscQueueHook m_stub;
+};
@@ -0,0 +1,128 @@
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include "Benchmark.hpp"
+#include "NullableColumn.hpp"
+
+void test_ours() {
+    NullableColumn<int> col;
+    col.push_back(3);
+    col.push_null();
+    col.push_back(Optional<int>(-7));
+    int more[] = {10, 20, 30};
+    col.append(more, 3);
+    col.append_nulls(70);
+    col.set(1, 5);
+    printf("size = %zd, nulls = %zd, count = %zd\n", col.size(), col.null_count(), col.count());
+    for (size_t i = 0; i < 7; i++) {
+        auto v = col[i];
+        if (v.has_value())
+            printf("%d ", *v);
+        else
+            printf("null ");
+    }
+    printf("\nsum = %ld, min = %d, max = %d\n", (long)col.sum(), col.min().value(), col.max().value());
+    NullableColumn<int> copy;
+    copy.append(col);
+    printf("copy: size = %zd, nulls = %zd, sum = %ld\n", copy.size(), copy.null_count(), (long)copy.sum());
+    // 追加自己: 扩容后不能再读旧的指针
+    copy.append(copy);
+    printf("self append: size = %zd, nulls = %zd, sum = %ld\n", copy.size(), copy.null_count(), (long)copy.sum());
+    printf("count(1, 6) = %zd, count(0, size) = %zd, count(70, 140) = %zd\n",
+           col.count(1, 6), col.count(0, col.size()), copy.count(70, 140));
+    NullableColumn<double> empty;
+    empty.append_nulls(100);
+    printf("all null: sum = %g, min has_value = %d\n", empty.sum(), empty.min().has_value());
+}
+
+// Vector<Optional<T>>上的同样三个聚合
+template <class T>
+struct OptionalColumn {
+    Vector<Optional<T>> m_values;
+
+    auto sum() const {
+        typename NullableColumn<T>::SumType total = 0;
+        for (auto const &v: m_values) {
+            if (v.has_value())
+                total += *v;
+        }
+        return total;
+    }
+
+    Optional<T> min() const {
+        Optional<T> best;
+        for (auto const &v: m_values) {
+            if (v.has_value() && (!best.has_value() || *v < *best))
+                best = *v;
+        }
+        return best;
+    }
+
+    size_t count(size_t first, size_t last) const {
+        size_t n = 0;
+        for (size_t i = first; i != last; i++)
+            n += m_values[i].has_value();
+        return n;
+    }
+};
+
+// null_rate: 空值比例; run: 空值成段出现时每段的长度(1表示随机分布)
+template <class T>
+void bench_column(char const *type, size_t n, double null_rate, size_t run) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> dist(0, 1);
+    NullableColumn<T> col;
+    OptionalColumn<T> opt;
+    col.reserve(n);
+    opt.m_values.reserve(n);
+    for (size_t i = 0; i < n; i += run) {
+        bool null = dist(rng) < null_rate;
+        for (size_t k = i; k < i + run && k < n; k++) {
+            if (null) {
+                col.push_null();
+                opt.m_values.push_back(Optional<T>());
+            } else {
+                T value = (T)(rng() % 1000);
+                col.push_back(value);
+                opt.m_values.push_back(Optional<T>(value));
+            }
+        }
+    }
+    printf("== %s, %zd rows, %.0f%% null, null runs of %zd ==\n", type, n, null_rate * 100, run);
+    benchmark("Vector<Optional> sum", [&] { doNotOptimize(opt.sum()); }, n);
+    benchmark("NullableColumn sum", [&] { doNotOptimize(col.sum()); }, n);
+    benchmark("Vector<Optional> min", [&] { doNotOptimize(opt.min()); }, n);
+    benchmark("NullableColumn min", [&] { doNotOptimize(col.min()); }, n);
+    // count()整列是O(1)的缓存值, 这里测不对齐的子区间, 要真正数位图
+    benchmark("Vector<Optional> count(range)", [&] { doNotOptimize(opt.count(3, n - 5)); }, n);
+    benchmark("NullableColumn count(range)", [&] { doNotOptimize(col.count(3, n - 5)); }, n);
+}
+
+void bench_append(size_t n) {
+    Vector<int32_t> src;
+    for (size_t i = 0; i < n; i++)
+        src.push_back((int32_t)i);
+    printf("== bulk append %zd x int32_t ==\n", n);
+    benchmark("Vector<Optional> push_back", [&] {
+        Vector<Optional<int32_t>> opt;
+        for (size_t i = 0; i < n; i++)
+            opt.push_back(Optional<int32_t>(src[i]));
+        doNotOptimize(opt.data());
+    }, n);
+    benchmark("NullableColumn append", [&] {
+        NullableColumn<int32_t> col;
+        col.append(src.data(), n);
+        doNotOptimize(col.values());
+    }, n);
+}
+
+int main() {
+    test_ours();
+    size_t n = 1 << 24;
+    bench_column<int32_t>("int32_t", n, 0.1, 1);
+    bench_column<int32_t>("int32_t", n, 0.5, 1024);
+    bench_column<double>("double", n, 0.1, 1);
+    bench_column<double>("double", n, 0.9, 4096);
+    bench_append(n);
+    return 0;
+}
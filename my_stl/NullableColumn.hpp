@@ -0,0 +1,250 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include "Optional.hpp"
+#include "Vector.hpp"
+
+// 可空列(同Arrow的布局): 值连续存在Vector里, 是否为空单独存在一个按位打包的validity位图里
+// 第i个元素有值 <=> 位图第i位为1; 空的位置上值固定为T{}, 所以求和可以不看位图直接加
+// 比Vector<Optional<T>>省下每个元素补齐后的bool, 值数组也能被编译器向量化
+// 聚合时按64位一个字处理位图: 全空的字整段跳过, 全满的字走不带判断的稠密循环
+template <class T, class Alloc = std::allocator<T>>
+struct NullableColumn {
+    static_assert(std::is_arithmetic_v<T>, "NullableColumn is meant for numeric columns");
+
+    using value_type = T;
+    using WordAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<uint64_t>;
+    // 求和的累加类型: 浮点用double, 整数用64位
+    using SumType = std::conditional_t<std::is_floating_point_v<T>, double,
+                    std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+    static constexpr size_t kWordBits = 64;
+
+    Vector<T, Alloc> m_values;
+    Vector<uint64_t, WordAlloc> m_validity;
+    size_t m_null_count = 0;
+
+    NullableColumn() = default;
+
+    size_t size() const noexcept {
+        return m_values.size();
+    }
+
+    bool empty() const noexcept {
+        return m_values.size() == 0;
+    }
+
+    size_t null_count() const noexcept {
+        return m_null_count;
+    }
+
+    // 非空元素个数, 由m_null_count维护, O(1)
+    size_t count() const noexcept {
+        return size() - m_null_count;
+    }
+
+    // [first, last)里的非空元素个数: 按字popcount位图, 首尾两个字用掩码去掉范围外的位
+    size_t count(size_t first, size_t last) const noexcept {
+        if (first >= last)
+            return 0;
+        size_t first_word = first / kWordBits;
+        size_t last_word = (last - 1) / kWordBits;
+        uint64_t head = ~uint64_t(0) << (first % kWordBits);
+        uint64_t tail = ~uint64_t(0) >> (kWordBits - 1 - (last - 1) % kWordBits);
+        if (first_word == last_word)
+            return std::popcount(m_validity[first_word] & head & tail);
+        size_t total = std::popcount(m_validity[first_word] & head);
+        for (size_t w = first_word + 1; w != last_word; w++)
+            total += std::popcount(m_validity[w]);
+        return total + std::popcount(m_validity[last_word] & tail);
+    }
+
+    void reserve(size_t n) {
+        m_values.reserve(n);
+        m_validity.reserve(words_for(n));
+    }
+
+    void clear() noexcept {
+        m_values.clear();
+        m_validity.clear();
+        m_null_count = 0;
+    }
+
+    bool is_valid(size_t i) const noexcept {
+        return (m_validity[i / kWordBits] >> (i % kWordBits)) & 1;
+    }
+
+    Optional<T> operator[](size_t i) const noexcept {
+        if (!is_valid(i))
+            return Nullopt;
+        return m_values[i];
+    }
+
+    // 不检查位图, 空的位置上是T{}
+    T value_unchecked(size_t i) const noexcept {
+        return m_values[i];
+    }
+
+    T const *values() const noexcept {
+        return m_values.data();
+    }
+
+    uint64_t const *validity() const noexcept {
+        return m_validity.data();
+    }
+
+    void set(size_t i, Optional<T> const &value) noexcept {
+        bool was_valid = is_valid(i);
+        uint64_t bit = uint64_t(1) << (i % kWordBits);
+        if (value.has_value()) {
+            m_values[i] = *value;
+            m_validity[i / kWordBits] |= bit;
+            m_null_count -= !was_valid;
+        } else {
+            m_values[i] = T{};
+            m_validity[i / kWordBits] &= ~bit;
+            m_null_count += was_valid;
+        }
+    }
+
+    void push_back(T value) {
+        size_t i = size();
+        grow_bits(i + 1);
+        m_values.push_back(value);
+        m_validity[i / kWordBits] |= uint64_t(1) << (i % kWordBits);
+    }
+
+    void push_null() {
+        grow_bits(size() + 1);
+        m_values.push_back(T{});
+        ++m_null_count;
+    }
+
+    void push_back(Optional<T> const &value) {
+        if (value.has_value())
+            push_back(*value);
+        else
+            push_null();
+    }
+
+    // 追加n个非空值
+    void append(T const *values, size_t n) {
+        size_t start = size();
+        grow_bits(start + n);
+        m_values.insert(m_values.end(), values, values + n);
+        set_bits(start, start + n);
+    }
+
+    // 追加n个值, 是否为空由Arrow格式的位图给出(第bit_offset位开始)
+    // 空的位置上写T{}, 保持"空位为零"的约定
+    void append(T const *values, uint64_t const *validity, size_t bit_offset, size_t n) {
+        size_t start = size();
+        grow_bits(start + n);
+        m_values.reserve(start + n);
+        for (size_t k = 0; k != n; k++) {
+            size_t b = bit_offset + k;
+            bool valid = (validity[b / kWordBits] >> (b % kWordBits)) & 1;
+            m_values.push_back(valid ? values[k] : T{});
+            m_validity[(start + k) / kWordBits] |= uint64_t(valid) << ((start + k) % kWordBits);
+            m_null_count += !valid;
+        }
+    }
+
+    void append_nulls(size_t n) {
+        grow_bits(size() + n);
+        m_values.resize(size() + n, T{});
+        m_null_count += n;
+    }
+
+    // other可能就是自己(c.append(c)): 先按最终大小扩容再取指针, 否则指针指向扩容前释放掉的内存
+    void append(NullableColumn const &other) {
+        size_t n = other.size();
+        reserve(size() + n);
+        grow_bits(size() + n);
+        append(other.values(), other.validity(), 0, n);
+    }
+
+    // 空位都是零, 全满和部分有值的字都直接加, 只跳过全空的字
+    SumType sum() const noexcept {
+        SumType total = 0;
+        for_each_word([&] (T const *p, size_t n, uint64_t word) {
+            if (word == 0)
+                return;
+            SumType s = 0;
+            for (size_t k = 0; k != n; k++)
+                s += p[k];
+            total += s;
+        });
+        return total;
+    }
+
+    Optional<T> min() const noexcept {
+        return reduce([] (T a, T b) { return b < a ? b : a; }, std::numeric_limits<T>::max());
+    }
+
+    Optional<T> max() const noexcept {
+        return reduce([] (T a, T b) { return a < b ? b : a; }, std::numeric_limits<T>::lowest());
+    }
+
+private:
+    static size_t words_for(size_t n) noexcept {
+        return (n + kWordBits - 1) / kWordBits;
+    }
+
+    // 新增的字初始为0, 即新位置默认为空
+    void grow_bits(size_t n) {
+        size_t words = words_for(n);
+        if (words > m_validity.size())
+            m_validity.resize(words, 0);
+    }
+
+    // 把[first, last)位置1, 中间整字直接填满
+    void set_bits(size_t first, size_t last) noexcept {
+        while (first != last && first % kWordBits != 0) {
+            m_validity[first / kWordBits] |= uint64_t(1) << (first % kWordBits);
+            ++first;
+        }
+        for (; last - first >= kWordBits; first += kWordBits)
+            m_validity[first / kWordBits] = ~uint64_t(0);
+        for (; first != last; ++first)
+            m_validity[first / kWordBits] |= uint64_t(1) << (first % kWordBits);
+    }
+
+    // 按位图的字切块: visitor(该字对应的值, 个数, 位图字), 最后一个字可能不满64个
+    template <class Visitor>
+    void for_each_word(Visitor visitor) const {
+        size_t n = size();
+        T const *p = m_values.data();
+        for (size_t w = 0; w * kWordBits < n; w++) {
+            size_t len = std::min(kWordBits, n - w * kWordBits);
+            visitor(p + w * kWordBits, len, m_validity[w]);
+        }
+    }
+
+    // 全满的字不看位图, 部分有值的字把空位替换成单位元, 都是无分支的循环
+    template <class Op>
+    Optional<T> reduce(Op op, T identity) const noexcept {
+        if (count() == 0)
+            return Nullopt;
+        T acc = identity;
+        for_each_word([&] (T const *p, size_t n, uint64_t word) {
+            if (word == 0)
+                return;
+            T local = identity;
+            if (n == kWordBits && word == ~uint64_t(0)) {
+                for (size_t k = 0; k != kWordBits; k++)
+                    local = op(local, p[k]);
+            } else {
+                for (size_t k = 0; k != n; k++)
+                    local = op(local, ((word >> k) & 1) ? p[k] : identity);
+            }
+            acc = op(acc, local);
+        });
+        return acc;
+    }
+};
@@ -1,5 +1,8 @@
 #include <iostream>
 #include <optional>
+#include <string>
+#include <vector>
+#include "Benchmark.hpp"
 #include "Optional.hpp"
 
 
@@ -20,7 +23,96 @@ void test_ours() {
 
     Optional<int> opt2(Nullopt);
     std::cout << opt2.has_value() << '\n';
-    std::cout << opt2.value() << '\n';
+    try {
+        std::cout << opt2.value() << '\n';
+    } catch (BadOptionalAccess const &e) {
+        std::cout << "opt2 " << e.what() << '\n';
+    }
+
+    // 以前这个重载会对const引用调用move, 实际退化成拷贝; 现在直接拷贝
+    std::string const s = "hello";
+    Optional<std::string> opt4(s);
+    std::cout << *opt4 << ' ' << s << '\n';
+}
+
+// T平凡时Optional<T>也平凡; T不平凡时特殊成员函数不平凡, 但依然可用
+static_assert(std::is_trivially_copyable_v<Optional<int>>);
+static_assert(std::is_trivially_destructible_v<Optional<double>>);
+static_assert(std::is_trivially_copy_assignable_v<Optional<int *>>);
+static_assert(!std::is_trivially_copyable_v<Optional<std::string>>);
+static_assert(std::is_copy_constructible_v<Optional<std::string>>);
+static_assert(sizeof(Optional<long>) == 2 * sizeof(long));
+
+// 整个API都能在编译期求值
+constexpr int test_constexpr() {
+    Optional<int> a;
+    Optional<int> b(InPlace, 20);
+    a = b;
+    a.emplace(*a + 1);
+    Optional<int> c = std::move(a);
+    c.swap(b);
+    b.reset();
+    return c.value() + b.value_or(1) + (b == Nullopt);
+}
+static_assert(test_constexpr() == 22);
+
+constexpr int test_constexpr_nontrivial() {
+    Optional<std::vector<int>> v(InPlace, {1, 2, 3});
+    Optional<std::vector<int>> w = v;
+    w->push_back(4);
+    return (int)w->size() + (int)v->size();
+}
+static_assert(test_constexpr_nontrivial() == 7);
+
+// 与long一样平凡, 但拷贝构造函数是用户提供的, 所以不平凡
+struct NonTrivialLong {
+    long m_value;
+
+    NonTrivialLong(long v) : m_value(v) {}
+    NonTrivialLong(NonTrivialLong const &that) : m_value(that.m_value) {}
+    NonTrivialLong &operator=(NonTrivialLong const &) = default;
+};
+
+// Optional<long>是16字节的平凡类型, 按值传参时用rdi/rsi两个寄存器
+// Optional<NonTrivialLong>不平凡, 调用者要在栈上拷一份再把地址传进去
+// 可以用 objdump -d --no-show-raw-insn Optional | grep -A8 'sum_optional' 查看
+template <class T>
+[[gnu::noinline]] long sum_optional(long acc, Optional<T> opt) {
+    if (opt.has_value())
+        return acc + (long)*opt;
+    return acc;
+}
+
+[[gnu::noinline]] long sum_optional_nt(long acc, Optional<NonTrivialLong> opt) {
+    if (opt.has_value())
+        return acc + opt->m_value;
+    return acc;
+}
+
+void bench_pass_by_value(size_t n) {
+    std::vector<Optional<long>> trivial;
+    std::vector<Optional<NonTrivialLong>> nontrivial;
+    for (size_t i = 0; i < n; i++) {
+        if (i % 4 == 0) {
+            trivial.emplace_back(Nullopt);
+            nontrivial.emplace_back(Nullopt);
+        } else {
+            trivial.emplace_back((long)i);
+            nontrivial.emplace_back(NonTrivialLong((long)i));
+        }
+    }
+    benchmark("pass Optional<long> by value", [&] {
+        long acc = 0;
+        for (auto const &opt: trivial)
+            acc = sum_optional(acc, opt);
+        doNotOptimize(acc);
+    }, n);
+    benchmark("pass Optional<NonTrivialLong> by value", [&] {
+        long acc = 0;
+        for (auto const &opt: nontrivial)
+            acc = sum_optional_nt(acc, opt);
+        doNotOptimize(acc);
+    }, n);
 }
 
 void test_std() {
@@ -46,6 +138,7 @@ void test_std() {
 
 int main() {
     test_ours();
+    bench_pass_by_value(1 << 24);
     // test_std();
     return 0;
 }
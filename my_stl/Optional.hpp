@@ -20,7 +20,7 @@ struct Nullopt_t {
     explicit Nullopt_t() = default;
 };
 
-inline Nullopt_t Nullopt;
+inline constexpr Nullopt_t Nullopt{};
 
 struct InPlace_t {
     explicit InPlace_t() = default;
@@ -30,215 +30,227 @@ inline constexpr InPlace_t InPlace;
 
 template <class T>
 struct Optional {
-    Optional(T &&value) : m_has_value(true), m_value(std::move(value)) {}
-    Optional(T const &value) : m_has_value(true), m_value(std::move(value)) {}
+    constexpr Optional(T &&value) : m_has_value(true), m_value(std::move(value)) {}
+    constexpr Optional(T const &value) : m_has_value(true), m_value(value) {}
     
-    Optional() noexcept : m_has_value(false) {}
+    constexpr Optional() noexcept : m_has_value(false) {}
 
-    Optional(Nullopt_t) noexcept : m_has_value(false) {}
+    constexpr Optional(Nullopt_t) noexcept : m_has_value(false) {}
 
     template <class ...Ts>
-    explicit Optional(InPlace_t, Ts ...value_args) noexcept : m_has_value(true), m_value(std::forward<Ts>(value_args)...) {}
+    constexpr explicit Optional(InPlace_t, Ts &&...value_args) : m_has_value(true), m_value(std::forward<Ts>(value_args)...) {}
 
     template <class U, class ...Ts>
-    explicit Optional(InPlace_t, std::initializer_list<U> ilist, Ts &&...value_args) noexcept : m_has_value(true), m_value(ilist, std::forward<Ts>(value_args)...) {}
+    constexpr explicit Optional(InPlace_t, std::initializer_list<U> ilist, Ts &&...value_args) : m_has_value(true), m_value(ilist, std::forward<Ts>(value_args)...) {}
 
-    Optional(Optional const &other) : m_has_value(other.m_has_value) {
+    // 特殊成员函数按T是否平凡分两套(C++20 requires约束):
+    // T平凡时用=default, Optional<T>也平凡, 可以memcpy, 按值传参时直接放在寄存器里
+    // T不平凡时才需要根据m_has_value手动构造/析构
+    constexpr Optional(Optional const &) requires std::is_trivially_copy_constructible_v<T> = default;
+
+    constexpr Optional(Optional const &other) : m_has_value(other.m_has_value) {
         if (m_has_value) {
-            new (&m_value) T(other.m_value); //placement-new (不分配内存只是构造)
+            std::construct_at(&m_value, other.m_value); // 同placement-new (不分配内存只是构造), 但可以用在constexpr里
         }
     }
 
-    Optional(Optional &&other) noexcept : m_has_value(other.m_has_value) {
+    constexpr Optional(Optional &&) requires std::is_trivially_move_constructible_v<T> = default;
+
+    constexpr Optional(Optional &&other) noexcept(std::is_nothrow_move_constructible_v<T>) : m_has_value(other.m_has_value) {
         if (m_has_value) {
-            new (&m_value) T(std::move(other.m_value)); // 此处that已退化为左值引用，使用move重新转为右值引用
+            std::construct_at(&m_value, std::move(other.m_value)); // 此处that已退化为左值引用，使用move重新转为右值引用
         }
     }
 
-    Optional &operator=(Nullopt_t) noexcept {
-        if (m_has_value) {
-            m_value.~T();
-            m_has_value = false;
-        }
+    constexpr Optional &operator=(Nullopt_t) noexcept {
+        reset();
         return *this;
     }
 
-    Optional &operator=(T value) noexcept {
+    constexpr Optional &operator=(T value) {
         if (m_has_value) {
-            m_value.~T();
-            m_has_value = false;
+            m_value = std::move(value);
+        } else {
+            std::construct_at(&m_value, std::move(value));
+            m_has_value = true;
         }
-        new (&m_value) T(std::move(value));
-        m_has_value = true;
         return *this;
     }
 
-    Optional &operator=(Optional const &other) {
+    constexpr Optional &operator=(Optional const &) requires std::is_trivially_copy_constructible_v<T>
+        && std::is_trivially_copy_assignable_v<T> && std::is_trivially_destructible_v<T> = default;
+
+    constexpr Optional &operator=(Optional const &other) {
         if (this == &other) return *this;
-        if (m_has_value) {
-            m_value.~T();
-            m_has_value = false;
-        }
-        if (other.m_has_value) {
-            new (&m_value) T(other.m_value);
+        if (m_has_value && other.m_has_value) {
+            m_value = other.m_value;
+        } else if (other.m_has_value) {
+            std::construct_at(&m_value, other.m_value);
+            m_has_value = true;
+        } else {
+            reset();
         }
-        m_has_value = other.m_has_value;
         return *this;
     }
 
-    Optional &operator=(Optional &&other) noexcept {
+    // 与std::optional一样, 被移动的一方仍然有值(值本身处于被移走的状态)
+    // 这样平凡版本(逐字节拷贝)和非平凡版本的行为一致
+    constexpr Optional &operator=(Optional &&) requires std::is_trivially_move_constructible_v<T>
+        && std::is_trivially_move_assignable_v<T> && std::is_trivially_destructible_v<T> = default;
+
+    constexpr Optional &operator=(Optional &&other) noexcept(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>) {
         if (this == &other) return *this;
-        if (m_has_value) {
-            m_value.~T();
-            m_has_value = false;
-        }
-        if (other.m_has_value) {
-            new (&m_value) T(std::move(other.m_value));
-            other.m_value.~T();
+        if (m_has_value && other.m_has_value) {
+            m_value = std::move(other.m_value);
+        } else if (other.m_has_value) {
+            std::construct_at(&m_value, std::move(other.m_value));
+            m_has_value = true;
+        } else {
+            reset();
         }
-        m_has_value = other.m_has_value;
-        other.m_has_value = false;
         return *this;
     }
 
-    ~Optional() noexcept {
+    constexpr ~Optional() requires std::is_trivially_destructible_v<T> = default;
+
+    constexpr ~Optional() noexcept {
         if (m_has_value) {
-            m_value.~T(); // 不释放内存只是析构
+            std::destroy_at(&m_value); // 不释放内存只是析构
         }
     }
 
-    bool has_value() const noexcept {
+    constexpr bool has_value() const noexcept {
         return m_has_value;
     }
     
-    T const &value() const & {
+    constexpr T const &value() const & {
         if (!m_has_value)
             throw BadOptionalAccess();
         return m_value;
     }
 
-    T &value() & {
+    constexpr T &value() & {
         if (!m_has_value)
             throw BadOptionalAccess();
         return m_value;
     }
 
-    T const &&value() const && {
+    constexpr T const &&value() const && {
         if (!m_has_value)
             throw BadOptionalAccess();
         return std::move(m_value);
     }
 
-    T &&value() && {
+    constexpr T &&value() && {
         if (!m_has_value)
             throw BadOptionalAccess();
         return std::move(m_value);
     }
 
-    T const &operator*() const & noexcept {
+    constexpr T const &operator*() const & noexcept {
         return m_value;
     }
 
-    T &operator*() & noexcept {
+    constexpr T &operator*() & noexcept {
         return m_value;
     }
 
-    T &&operator*() && noexcept {
+    constexpr T &&operator*() && noexcept {
         return std::move(m_value);
     }
 
-    T const &&operator*() const && noexcept {
+    constexpr T const &&operator*() const && noexcept {
         return std::move(m_value);
     }
 
-    T const *operator->() const noexcept {
+    constexpr T const *operator->() const noexcept {
         return std::addressof(m_value);
     }
 
-    T *operator->() noexcept {
+    constexpr T *operator->() noexcept {
         return std::addressof(m_value);
     }
 
-    explicit operator bool()  const noexcept {
+    constexpr explicit operator bool()  const noexcept {
         return m_has_value;
     }
 
     // 拷贝考虑string,不加noexcept
-    T value_or(T default_value) const & {
+    constexpr T value_or(T default_value) const & {
         if (!m_has_value)
             return default_value;
         return m_value;
     }
 
-    T value_or(T default_value)  && noexcept(std::is_nothrow_move_assignable_v<T>) {
+    constexpr T value_or(T default_value)  && noexcept(std::is_nothrow_move_assignable_v<T>) {
         if (!m_has_value)
             return default_value;
         return std::move(m_value);
     }
 
     template <class ...Ts>
-    void emplace(Ts &&...args) noexcept {
+    constexpr void emplace(Ts &&...args) {
         if (m_has_value) {
-            m_value.~T();
+            std::destroy_at(&m_value);
             m_has_value = false;
         }
-        new (&m_value) T(std::forward<Ts>(args)...);
+        std::construct_at(&m_value, std::forward<Ts>(args)...);
         m_has_value = true;
     }
 
     template <class U, class ...Ts>
-    void emplace(std::initializer_list<U> ilist, Ts &&...value_args) {
+    constexpr void emplace(std::initializer_list<U> ilist, Ts &&...value_args) {
         if (m_has_value) {
-            m_value.~T();
+            std::destroy_at(&m_value);
             m_has_value = false;
         }
-        new (&m_value) T(ilist,std::forward<Ts>(value_args)...);
+        std::construct_at(&m_value, ilist, std::forward<Ts>(value_args)...);
         m_has_value = true;
     }
 
-    void reset() noexcept {
+    constexpr void reset() noexcept {
         if (m_has_value) {
-            m_value.~T();
+            std::destroy_at(&m_value);
             m_has_value = false;
         }
     }
 
-    void swap(Optional &other) noexcept {
+    constexpr void swap(Optional &other) noexcept {
         if (m_has_value && other.m_has_value) {
             using std::swap; // 利用ADL实现多态效果
             // 若对象的类型在自己的名字空间定义了swap，优先调用对象的swap函数
             std::swap(m_value, other.m_value);
         } else if (m_has_value) {
-            new (&other.m_value) T(std::move(m_value));
-            m_value.~T();
+            std::construct_at(&other.m_value, std::move(m_value));
+            std::destroy_at(&m_value);
             m_has_value = false;
             other.m_has_value = true;
         } else if (other.m_has_value) {
-            new (&m_value) T(std::move(other.m_value));
-            other.m_value.~T();
+            std::construct_at(&m_value, std::move(other.m_value));
+            std::destroy_at(&other.m_value);
             m_has_value = true;
             other.m_has_value = false;
         }
     }
 
-    bool operator==(Nullopt_t) const noexcept {
+    constexpr bool operator==(Nullopt_t) const noexcept {
         return !m_has_value;
     }
 
-    friend bool operator==(Nullopt_t, Optional const &opt) noexcept {
+    friend constexpr bool operator==(Nullopt_t, Optional const &opt) noexcept {
         return !opt.m_has_value;
     }
 
-    bool operator!=(Nullopt_t) const noexcept {
+    constexpr bool operator!=(Nullopt_t) const noexcept {
         return m_has_value;
     }
 
-    friend bool operator!=(Nullopt_t, Optional const &opt) noexcept {
+    friend constexpr bool operator!=(Nullopt_t, Optional const &opt) noexcept {
         return opt.m_has_value;
     }
 
     template <class U>
-    bool operator==(Optional<U> const &other) const {
+    constexpr bool operator==(Optional<U> const &other) const {
         if (m_has_value != other.m_has_value) {
             return false;
         }
@@ -249,26 +261,26 @@ struct Optional {
     }
 
     template <class U>
-    bool operator!=(Optional<U> const &other) const {
+    constexpr bool operator!=(Optional<U> const &other) const {
         return !(*this == other);
     }
 
     template <class U>
-    bool operator<(Optional<U> const &other) const {
+    constexpr bool operator<(Optional<U> const &other) const {
         if (!m_has_value) 
             return false;
         return m_value<other.m_value;
     }
 
     template <class U>
-    bool operator<=(Optional<U> const &other) const noexcept {
+    constexpr bool operator<=(Optional<U> const &other) const noexcept {
         if (!m_has_value)
             return false;
         return m_value <= other.m_value;
     }
 
     template <class U>
-    bool operator>(Optional<U> const &other) const noexcept {
+    constexpr bool operator>(Optional<U> const &other) const noexcept {
         if (!m_has_value)
             return false;
         return m_value > other.m_value;
@@ -308,7 +320,7 @@ Optional(T) -> Optional<T>;
 #endif
 
 template <class T>
-Optional<T> makeOptional(T value) {
+constexpr Optional<T> makeOptional(T value) {
     return Optional<T>(std::move(value));
 }
 
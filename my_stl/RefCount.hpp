@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+
+// 引用计数的策略, SharedPtr的控制块和IntrusivePtr的RefCounted基类共用
+// 每个策略提供Count类型, 以及对它的increment/decrement/increment_if_nonzero/load/is_unique
+
+// 原子计数: 增加用relaxed(已经持有引用的线程才能增加)
+// 减少用release, 只有减到0的那一次再acquire, 保证析构前看到其他线程的所有写;
+// 常见情况(不是最后一个引用)就省掉了acquire, 在ARM这类弱内存序的机器上少一道屏障
+struct AtomicRefCount {
+    using Count = std::atomic<long>;
+
+    static void increment(Count &c) noexcept {
+        c.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 返回减完是否为0
+    static bool decrement(Count &c) noexcept {
+        if (c.fetch_sub(1, std::memory_order_release) != 1)
+            return false;
+        // fetch_sub组成release序列, acquire读到自己写的0就和之前所有的release减少同步
+        // 用acquire load而不是atomic_thread_fence, 效果一样, 而且TSAN认得
+        (void)c.load(std::memory_order_acquire);
+        return true;
+    }
+
+    // WeakPtr::lock用: 计数已经为0时不能再加回来
+    static bool increment_if_nonzero(Count &c) noexcept {
+        long n = c.load(std::memory_order_relaxed);
+        while (n != 0) {
+            if (c.compare_exchange_weak(n, n + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    static long load(Count const &c) noexcept {
+        return c.load(std::memory_order_relaxed);
+    }
+
+    // 计数为1说明只有调用者自己持有; acquire与其他持有者释放时的release配对
+    static bool is_unique(Count const &c) noexcept {
+        return c.load(std::memory_order_acquire) == 1;
+    }
+};
+
+// 非原子计数, 同一个控制块的所有SharedPtr/WeakPtr必须在同一个线程里
+struct PlainRefCount {
+    using Count = long;
+
+    static void increment(Count &c) noexcept {
+        ++c;
+    }
+
+    static bool decrement(Count &c) noexcept {
+        return --c == 0;
+    }
+
+    static bool increment_if_nonzero(Count &c) noexcept {
+        if (c == 0)
+            return false;
+        ++c;
+        return true;
+    }
+
+    static long load(Count const &c) noexcept {
+        return c;
+    }
+
+    static bool is_unique(Count const &c) noexcept {
+        return c == 1;
+    }
+};
@@ -0,0 +1,140 @@
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Benchmark.hpp"
+#include "SharedPtr.hpp"
+
+struct Base {
+    virtual ~Base() {
+        puts("~Base");
+    }
+};
+
+struct Derived : Base {
+    std::string m_name;
+
+    explicit Derived(std::string name) : m_name(std::move(name)) {}
+
+    ~Derived() override {
+        printf("~Derived(%s)\n", m_name.c_str());
+    }
+};
+
+struct Config {
+    int m_port;
+    std::string m_host;
+};
+
+void test_ours() {
+    SharedPtr<Derived> d = makeShared<Derived>("fused");
+    SharedPtr<Base> b = d;
+    printf("use_count = %ld, same object: %d\n", d.use_count(), b.get() == d.get());
+
+    WeakPtr<Derived> w = d;
+    d.reset();
+    printf("after reset: use_count = %ld, expired = %d\n", w.use_count(), w.expired());
+    if (auto locked = w.lock())
+        printf("lock: %s\n", locked->m_name.c_str());
+    b.reset();
+    printf("after last reset: expired = %d, lock empty = %d\n", w.expired(), !w.lock());
+    try {
+        SharedPtr<Derived> fail(w);
+    } catch (std::bad_weak_ptr const &e) {
+        printf("SharedPtr(expired weak): %s\n", e.what());
+    }
+
+    // 别名构造: 指向成员, 但让整个Config保持存活
+    SharedPtr<std::string> host;
+    {
+        auto cfg = makeShared<Config>(Config{8080, "example.org"});
+        host = SharedPtr<std::string>(cfg, &cfg->m_host);
+    }
+    printf("aliasing: host = %s, use_count = %ld\n", host->c_str(), host.use_count());
+
+    // 从裸指针和自定义删除器构造
+    SharedPtr<int> custom(new int(7), [] (int *p) {
+        printf("custom deleter %d\n", *p);
+        delete p;
+    });
+    custom.reset();
+
+    LocalSharedPtr<int> local = makeLocalShared<int>(3);
+    LocalSharedPtr<int> local2 = local;
+    printf("local use_count = %ld, sizeof(SharedPtr) = %zd\n", local.use_count(), sizeof(local));
+}
+
+// 共享指针按值传来传去: 每次拷贝和析构各改一次计数
+template <class Ptr>
+[[gnu::noinline]] uint64_t consume(Ptr p) {
+    return *p;
+}
+
+template <class Ptr, class Make>
+void bench_copy(char const *name, Make make, size_t n) {
+    Ptr p = make();
+    benchmark(name, [&] {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < n; i++)
+            sum += consume<Ptr>(p);
+        doNotOptimize(sum);
+    }, n);
+}
+
+// 一批指针拷贝进数组再全部析构
+template <class Ptr, class Make>
+void bench_fanout(char const *name, Make make, size_t n) {
+    Ptr p = make();
+    std::vector<Ptr> copies;
+    copies.reserve(1024);
+    benchmark(name, [&] {
+        for (size_t i = 0; i < n; i += 1024) {
+            for (size_t k = 0; k < 1024; k++)
+                copies.push_back(p);
+            copies.clear();
+        }
+    }, n);
+}
+
+template <class Ptr, class Make>
+void bench_make(char const *name, Make make, size_t n) {
+    benchmark(name, [&] {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < n; i++) {
+            Ptr p = make();
+            sum += *p;
+        }
+        doNotOptimize(sum);
+    }, n);
+}
+
+int main() {
+    test_ours();
+    size_t n = 1 << 24;
+    auto make_std = [] { return std::make_shared<uint64_t>(1); };
+    auto make_ours = [] { return makeShared<uint64_t>(1); };
+    auto make_local = [] { return makeLocalShared<uint64_t>(1); };
+    auto make_separate = [] { return SharedPtr<uint64_t>(new uint64_t(1)); };
+    // libstdc++的shared_ptr在进程还没创建过线程时自动改用非原子计数, 先看这种情况
+    printf("== pass by value, process has never started a thread ==\n");
+    bench_copy<std::shared_ptr<uint64_t>>("std::shared_ptr", make_std, n);
+    bench_copy<SharedPtr<uint64_t>>("SharedPtr (atomic)", make_ours, n);
+    // 一旦起过线程, std::shared_ptr就一直用原子指令; PlainRefCount则由类型决定, 不受影响
+    std::thread([] {}).join();
+    printf("== pass by value (copy + destroy) ==\n");
+    bench_copy<std::shared_ptr<uint64_t>>("std::shared_ptr", make_std, n);
+    bench_copy<SharedPtr<uint64_t>>("SharedPtr (atomic)", make_ours, n);
+    bench_copy<LocalSharedPtr<uint64_t>>("SharedPtr (plain)", make_local, n);
+    printf("== copy 1024 into a vector, then clear ==\n");
+    bench_fanout<std::shared_ptr<uint64_t>>("std::shared_ptr", make_std, n);
+    bench_fanout<SharedPtr<uint64_t>>("SharedPtr (atomic)", make_ours, n);
+    bench_fanout<LocalSharedPtr<uint64_t>>("SharedPtr (plain)", make_local, n);
+    printf("== create + destroy ==\n");
+    bench_make<std::shared_ptr<uint64_t>>("std::make_shared", make_std, n / 4);
+    bench_make<SharedPtr<uint64_t>>("makeShared (fused)", make_ours, n / 4);
+    bench_make<SharedPtr<uint64_t>>("SharedPtr(new T) (two allocations)", make_separate, n / 4);
+    bench_make<LocalSharedPtr<uint64_t>>("makeLocalShared", make_local, n / 4);
+    return 0;
+}
@@ -0,0 +1,348 @@
+#pragma once
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "RefCount.hpp"
+
+// 共享所有权的智能指针, 引用计数放在控制块里
+// 计数的方式由策略参数决定: AtomicRefCount用原子指令, 可以跨线程共享;
+// PlainRefCount用普通的加减, 只能在一个线程里用(比如单线程的事件循环), 省掉每次拷贝和析构的lock前缀指令
+// makeShared把对象和控制块放在同一次分配里
+
+namespace shared_ptr_detail {
+
+// 所有强引用合起来持有一个弱引用, 最后一个强引用析构对象, 最后一个弱引用释放控制块
+template <class Policy>
+struct ControlBlock {
+    typename Policy::Count m_strong{1};
+    typename Policy::Count m_weak{1};
+
+    // 析构被管理的对象
+    virtual void dispose() noexcept = 0;
+    // 释放控制块自己(makeShared时连同对象的内存)
+    virtual void deallocate() noexcept = 0;
+
+    void add_strong() noexcept {
+        Policy::increment(m_strong);
+    }
+
+    void add_weak() noexcept {
+        Policy::increment(m_weak);
+    }
+
+    bool try_add_strong() noexcept {
+        return Policy::increment_if_nonzero(m_strong);
+    }
+
+    // 没有WeakPtr时(最常见的情况)弱计数必然是1, 直接释放, 省掉一次原子减
+    void release_strong() noexcept {
+        if (Policy::decrement(m_strong)) {
+            dispose();
+            if (Policy::is_unique(m_weak))
+                deallocate();
+            else
+                release_weak();
+        }
+    }
+
+    void release_weak() noexcept {
+        if (Policy::decrement(m_weak))
+            deallocate();
+    }
+
+protected:
+    ~ControlBlock() = default;
+};
+
+// 从裸指针构造时: 控制块单独分配, 保存指针和删除器
+template <class Policy, class U, class Deleter>
+struct PointerBlock final : ControlBlock<Policy> {
+    U *m_ptr;
+    [[no_unique_address]] Deleter m_deleter;
+
+    PointerBlock(U *ptr, Deleter deleter) noexcept : m_ptr(ptr), m_deleter(std::move(deleter)) {}
+
+    void dispose() noexcept override {
+        m_deleter(m_ptr);
+    }
+
+    void deallocate() noexcept override {
+        delete this;
+    }
+};
+
+// makeShared时: 对象直接放在控制块后面, 一次分配, 访问对象时和计数在相邻的缓存行
+template <class Policy, class U>
+struct InplaceBlock final : ControlBlock<Policy> {
+    alignas(U) unsigned char m_storage[sizeof(U)];
+
+    template <class ...Args>
+    explicit InplaceBlock(Args &&...args) {
+        ::new (static_cast<void *>(m_storage)) U(std::forward<Args>(args)...);
+    }
+
+    U *get() noexcept {
+        return std::launder(reinterpret_cast<U *>(m_storage));
+    }
+
+    void dispose() noexcept override {
+        get()->~U();
+    }
+
+    void deallocate() noexcept override {
+        delete this;
+    }
+};
+
+} // namespace shared_ptr_detail
+
+template <class T, class Policy = AtomicRefCount>
+struct SharedPtr;
+
+template <class T, class Policy = AtomicRefCount>
+struct WeakPtr;
+
+template <class T, class Policy = AtomicRefCount, class ...Args>
+SharedPtr<T, Policy> makeShared(Args &&...args);
+
+template <class T, class Policy>
+struct SharedPtr {
+private:
+    template <class U, class UPolicy> friend struct SharedPtr;
+    template <class U, class UPolicy> friend struct WeakPtr;
+    template <class U, class UPolicy, class ...Args> friend SharedPtr<U, UPolicy> makeShared(Args &&...args);
+
+    using Block = shared_ptr_detail::ControlBlock<Policy>;
+
+    T *m_ptr = nullptr;
+    Block *m_cb = nullptr;
+
+    // 接管一个已经计过数的引用
+    SharedPtr(T *ptr, Block *cb) noexcept : m_ptr(ptr), m_cb(cb) {}
+
+public:
+    using element_type = T;
+
+    SharedPtr() noexcept = default;
+
+    SharedPtr(std::nullptr_t) noexcept {}
+
+    // 显式构造, 避免栈上的指针被隐式接管
+    template <class U> requires std::convertible_to<U *, T *>
+    explicit SharedPtr(U *ptr) : SharedPtr(ptr, std::default_delete<U>()) {}
+
+    // 分配控制块失败时用删除器释放ptr, 不泄漏
+    template <class U, class Deleter> requires (std::convertible_to<U *, T *> && std::is_invocable_v<Deleter &, U *>)
+    SharedPtr(U *ptr, Deleter deleter) : m_ptr(ptr) {
+        try {
+            m_cb = new shared_ptr_detail::PointerBlock<Policy, U, Deleter>(ptr, deleter);
+        } catch (...) {
+            deleter(ptr);
+            throw;
+        }
+    }
+
+    SharedPtr(SharedPtr const &that) noexcept : m_ptr(that.m_ptr), m_cb(that.m_cb) {
+        if (m_cb)
+            m_cb->add_strong();
+    }
+
+    SharedPtr(SharedPtr &&that) noexcept
+        : m_ptr(std::exchange(that.m_ptr, nullptr)), m_cb(std::exchange(that.m_cb, nullptr)) {}
+
+    template <class U> requires std::convertible_to<U *, T *>
+    SharedPtr(SharedPtr<U, Policy> const &that) noexcept : m_ptr(that.m_ptr), m_cb(that.m_cb) {
+        if (m_cb)
+            m_cb->add_strong();
+    }
+
+    template <class U> requires std::convertible_to<U *, T *>
+    SharedPtr(SharedPtr<U, Policy> &&that) noexcept
+        : m_ptr(std::exchange(that.m_ptr, nullptr)), m_cb(std::exchange(that.m_cb, nullptr)) {}
+
+    // 别名构造: 和that共享所有权, 但指向ptr(通常是that所指对象的成员)
+    template <class U>
+    SharedPtr(SharedPtr<U, Policy> const &that, T *ptr) noexcept : m_ptr(ptr), m_cb(that.m_cb) {
+        if (m_cb)
+            m_cb->add_strong();
+    }
+
+    template <class U>
+    SharedPtr(SharedPtr<U, Policy> &&that, T *ptr) noexcept : m_ptr(ptr), m_cb(std::exchange(that.m_cb, nullptr)) {
+        that.m_ptr = nullptr;
+    }
+
+    // 对象已经析构时抛出std::bad_weak_ptr, 同std
+    template <class U> requires std::convertible_to<U *, T *>
+    explicit SharedPtr(WeakPtr<U, Policy> const &weak) : m_ptr(weak.m_ptr), m_cb(weak.m_cb) {
+        if (m_cb == nullptr || !m_cb->try_add_strong())
+            throw std::bad_weak_ptr();
+    }
+
+    ~SharedPtr() noexcept {
+        if (m_cb)
+            m_cb->release_strong();
+    }
+
+    SharedPtr &operator=(SharedPtr const &that) noexcept {
+        SharedPtr(that).swap(*this);
+        return *this;
+    }
+
+    SharedPtr &operator=(SharedPtr &&that) noexcept {
+        SharedPtr(std::move(that)).swap(*this);
+        return *this;
+    }
+
+    template <class U> requires std::convertible_to<U *, T *>
+    SharedPtr &operator=(SharedPtr<U, Policy> const &that) noexcept {
+        SharedPtr(that).swap(*this);
+        return *this;
+    }
+
+    template <class U> requires std::convertible_to<U *, T *>
+    SharedPtr &operator=(SharedPtr<U, Policy> &&that) noexcept {
+        SharedPtr(std::move(that)).swap(*this);
+        return *this;
+    }
+
+    void reset() noexcept {
+        SharedPtr().swap(*this);
+    }
+
+    template <class U> requires std::convertible_to<U *, T *>
+    void reset(U *ptr) {
+        SharedPtr(ptr).swap(*this);
+    }
+
+    void swap(SharedPtr &that) noexcept {
+        std::swap(m_ptr, that.m_ptr);
+        std::swap(m_cb, that.m_cb);
+    }
+
+    T *get() const noexcept {
+        return m_ptr;
+    }
+
+    T &operator*() const noexcept {
+        return *m_ptr;
+    }
+
+    T *operator->() const noexcept {
+        return m_ptr;
+    }
+
+    explicit operator bool() const noexcept {
+        return m_ptr != nullptr;
+    }
+
+    long use_count() const noexcept {
+        return m_cb ? Policy::load(m_cb->m_strong) : 0;
+    }
+
+    // 是否和that共享同一个控制块(别名构造出来的指针地址不同, 但所有权相同)
+    template <class U>
+    bool owner_equal(SharedPtr<U, Policy> const &that) const noexcept {
+        return m_cb == that.m_cb;
+    }
+
+    template <class U>
+    bool operator==(SharedPtr<U, Policy> const &that) const noexcept {
+        return m_ptr == that.m_ptr;
+    }
+
+    bool operator==(std::nullptr_t) const noexcept {
+        return m_ptr == nullptr;
+    }
+};
+
+template <class T, class Policy>
+struct WeakPtr {
+private:
+    template <class U, class UPolicy> friend struct SharedPtr;
+    template <class U, class UPolicy> friend struct WeakPtr;
+
+    using Block = shared_ptr_detail::ControlBlock<Policy>;
+
+    T *m_ptr = nullptr;
+    Block *m_cb = nullptr;
+
+public:
+    WeakPtr() noexcept = default;
+
+    template <class U> requires std::convertible_to<U *, T *>
+    WeakPtr(SharedPtr<U, Policy> const &shared) noexcept : m_ptr(shared.m_ptr), m_cb(shared.m_cb) {
+        if (m_cb)
+            m_cb->add_weak();
+    }
+
+    WeakPtr(WeakPtr const &that) noexcept : m_ptr(that.m_ptr), m_cb(that.m_cb) {
+        if (m_cb)
+            m_cb->add_weak();
+    }
+
+    WeakPtr(WeakPtr &&that) noexcept
+        : m_ptr(std::exchange(that.m_ptr, nullptr)), m_cb(std::exchange(that.m_cb, nullptr)) {}
+
+    ~WeakPtr() noexcept {
+        if (m_cb)
+            m_cb->release_weak();
+    }
+
+    WeakPtr &operator=(WeakPtr const &that) noexcept {
+        WeakPtr(that).swap(*this);
+        return *this;
+    }
+
+    WeakPtr &operator=(WeakPtr &&that) noexcept {
+        WeakPtr(std::move(that)).swap(*this);
+        return *this;
+    }
+
+    void reset() noexcept {
+        WeakPtr().swap(*this);
+    }
+
+    void swap(WeakPtr &that) noexcept {
+        std::swap(m_ptr, that.m_ptr);
+        std::swap(m_cb, that.m_cb);
+    }
+
+    long use_count() const noexcept {
+        return m_cb ? Policy::load(m_cb->m_strong) : 0;
+    }
+
+    bool expired() const noexcept {
+        return use_count() == 0;
+    }
+
+    // 对象还活着时返回一个强引用, 否则返回空
+    SharedPtr<T, Policy> lock() const noexcept {
+        if (m_cb != nullptr && m_cb->try_add_strong())
+            return SharedPtr<T, Policy>(m_ptr, m_cb);
+        return SharedPtr<T, Policy>();
+    }
+};
+
+// 对象和控制块一次分配
+template <class T, class Policy, class ...Args>
+SharedPtr<T, Policy> makeShared(Args &&...args) {
+    auto *block = new shared_ptr_detail::InplaceBlock<Policy, T>(std::forward<Args>(args)...);
+    return SharedPtr<T, Policy>(block->get(), block);
+}
+
+// 单线程用的版本
+template <class T>
+using LocalSharedPtr = SharedPtr<T, PlainRefCount>;
+
+template <class T>
+using LocalWeakPtr = WeakPtr<T, PlainRefCount>;
+
+template <class T, class ...Args>
+LocalSharedPtr<T> makeLocalShared(Args &&...args) {
+    return makeShared<T, PlainRefCount>(std::forward<Args>(args)...);
+}
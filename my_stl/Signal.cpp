@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Benchmark.hpp"
+#include "Signal.hpp"
+
+struct Quote {
+    uint32_t m_symbol;
+    double m_price;
+};
+
+void test_ours() {
+    Signal<void(Quote const &)> on_quote;
+    double last = 0;
+    int count = 0;
+    Connection c1 = on_quote.connect([&last] (Quote const &q) { last = q.m_price; });
+    {
+        ScopedConnection c2 = on_quote.connect([&count] (Quote const &) { ++count; });
+        on_quote.emit(Quote{1, 10.5});
+        on_quote(Quote{2, 11.25});
+        printf("slots = %zd, last = %g, count = %d\n", on_quote.size(), last, count);
+    }
+    on_quote.emit(Quote{3, 12.0});
+    printf("after scope: slots = %zd, last = %g, count = %d\n", on_quote.size(), last, count);
+    c1.disconnect();
+    on_quote.emit(Quote{4, 13.0});
+    printf("after disconnect: slots = %zd, last = %g, connected = %d\n", on_quote.size(), last, c1.connected());
+
+    // 槽函数里可以再emit
+    Signal<void(int)> chain;
+    int depth = 0;
+    ScopedConnection c3 = chain.connect([&] (int n) {
+        depth = std::max(depth, n);
+        if (n < 3)
+            chain.emit(n + 1);
+    });
+    chain.emit(0);
+    printf("nested emit depth = %d\n", depth);
+
+    // 一次性订阅: 槽函数里断开自己, 写者不等待读者, 不会卡住
+    Signal<void()> tick;
+    int once_fired = 0, added_fired = 0;
+    Connection once;
+    once = tick.connect([&] {
+        ++once_fired;
+        once.disconnect();
+    });
+    // 槽函数里连接新的槽, 从下一次emit开始生效
+    ScopedConnection adder = tick.connect([&] {
+        if (added_fired == 0 && tick.size() == 1) {
+            Connection c = tick.connect([&added_fired] { ++added_fired; });
+            (void)c;
+        }
+    });
+    tick.emit();
+    tick.emit();
+    tick.emit();
+    printf("self-disconnect: once fired %d, connected = %d; added slot fired %d, slots = %zd\n",
+           once_fired, once.connected(), added_fired, tick.size());
+}
+
+// 对照: 一把互斥锁保护的std::function数组, emit时加锁
+template <class ...Args>
+struct LockedSignal {
+    std::mutex m_mutex;
+    std::vector<std::pair<uint64_t, std::function<void(Args...)>>> m_slots;
+    uint64_t m_next_id = 1;
+
+    template <class F>
+    uint64_t connect(F f) {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_slots.emplace_back(m_next_id, std::move(f));
+        return m_next_id++;
+    }
+
+    void disconnect(uint64_t id) {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        for (auto it = m_slots.begin(); it != m_slots.end(); ++it) {
+            if (it->first == id) {
+                m_slots.erase(it);
+                return;
+            }
+        }
+    }
+
+    void emit(Args ...args) {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        for (auto &slot: m_slots)
+            slot.second(args...);
+    }
+};
+
+// 每个订阅者累加自己的一份统计, 互不共享
+struct Subscriber {
+    uint64_t m_sum = 0;
+};
+
+void bench_emit(size_t slots, size_t n) {
+    printf("== emit to %zd slots ==\n", slots);
+    std::vector<Subscriber> subs(slots);
+    Signal<void(Quote const &)> sig;
+    LockedSignal<Quote const &> locked;
+    std::vector<ScopedConnection> conns;
+    for (auto &s: subs) {
+        conns.emplace_back(sig.connect([&s] (Quote const &q) { s.m_sum += q.m_symbol; }));
+        locked.connect([&s] (Quote const &q) { s.m_sum += q.m_symbol; });
+    }
+    benchmark("Signal emit", [&] {
+        for (size_t i = 0; i < n; i++)
+            sig.emit(Quote{(uint32_t)i, 1.0});
+    }, n * slots);
+    benchmark("mutex + vector<std::function> emit", [&] {
+        for (size_t i = 0; i < n; i++)
+            locked.emit(Quote{(uint32_t)i, 1.0});
+    }, n * slots);
+    doNotOptimize(subs.data());
+}
+
+// 若干线程不停地emit, 主线程同时反复连接/断开一个槽
+// 分别统计emit的吞吐量和一次连接加断开的耗时
+template <class Sig, class Connect, class Disconnect>
+void bench_churn(char const *name, Sig &sig, Connect connect, Disconnect disconnect, size_t emitters, size_t churns) {
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> emitted{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < emitters; t++) {
+        threads.emplace_back([&] {
+            uint64_t local = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                sig.emit(Quote{(uint32_t)local, 1.0});
+                ++local;
+            }
+            emitted.fetch_add(local);
+        });
+    }
+    std::atomic<uint64_t> sink{0};
+    double ns = benchmark(name, [&] {
+        for (size_t i = 0; i < churns; i++) {
+            auto id = connect(sig, [&sink] (Quote const &q) { sink.fetch_add(q.m_symbol, std::memory_order_relaxed); });
+            disconnect(sig, id);
+        }
+    }, churns);
+    stop.store(true);
+    for (auto &th: threads)
+        th.join();
+    printf("%-40s %10.1f emits/us\n", "  concurrent emit throughput", emitted.load() / (ns / 1e3));
+    doNotOptimize(sink.load());
+}
+
+void bench_churn_all(size_t emitters, size_t churns) {
+    printf("== connect + disconnect under %zd emitting threads, 10 resident slots ==\n", emitters);
+    // 多个线程同时emit, 订阅者的统计要用原子变量
+    std::vector<std::atomic<uint64_t>> subs(10);
+    Signal<void(Quote const &)> sig;
+    LockedSignal<Quote const &> locked;
+    std::vector<ScopedConnection> conns;
+    for (auto &s: subs) {
+        conns.emplace_back(sig.connect([&s] (Quote const &q) { s.fetch_add(q.m_symbol, std::memory_order_relaxed); }));
+        locked.connect([&s] (Quote const &q) { s.fetch_add(q.m_symbol, std::memory_order_relaxed); });
+    }
+    bench_churn("Signal connect/disconnect", sig,
+                [] (auto &s, auto f) { return s.connect(f); },
+                [] (auto &, Connection c) { c.disconnect(); }, emitters, churns);
+    bench_churn("LockedSignal connect/disconnect", locked,
+                [] (auto &s, auto f) { return s.connect(f); },
+                [] (auto &s, uint64_t id) { s.disconnect(id); }, emitters, churns);
+    doNotOptimize(subs.data());
+}
+
+int main() {
+    test_ours();
+    // glibc在进程还没创建过线程时, 互斥锁不用原子指令; 先起一个线程, 让对照组按多线程程序的真实开销计时
+    std::thread([] {}).join();
+    size_t n = 1 << 20;
+    bench_emit(1, n * 4);
+    bench_emit(10, n);
+    bench_emit(100, n / 10);
+    bench_churn_all(2, 1 << 14);
+    return 0;
+}
@@ -0,0 +1,337 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "Vector.hpp"
+
+// 信号/槽: 一个事件分发给所有连接上的槽函数
+// 槽函数按Function的方式擦除类型: 可调用对象单独放在堆上, 槽数组里只存调用函数和对象指针
+// 槽数组是连续的, emit就是顺序扫一遍数组, 每个槽一次间接调用
+// 连接/断开用类似RCU的写时复制: 复制一份新数组, 原子地替换指针, 旧数组和断开的槽挂到待回收列表上
+// 等所有可能还在读它们的emit都退出后, 由下一个写者或者最后退出的emit释放; 写者从不等待读者
+// 所以槽函数里可以连接/断开同一个信号, 包括断开自己(一次性的订阅)
+// emit从不加锁, 只在进入和退出时各做一次原子加减; 连接/断开之间用一把互斥锁串行化
+
+// 连接句柄, 不依赖信号的参数类型; 信号必须比连接活得久
+struct Connection {
+    void *m_signal = nullptr;
+    void (*m_disconnect)(void *signal, uint64_t id) = nullptr;
+    uint64_t m_id = 0;
+
+    Connection() = default;
+
+    Connection(void *signal, void (*disconnect)(void *, uint64_t), uint64_t id) noexcept
+        : m_signal(signal), m_disconnect(disconnect), m_id(id) {}
+
+    bool connected() const noexcept {
+        return m_signal != nullptr;
+    }
+
+    // 返回后开始的emit不会再调用这个槽; 已经在进行中的emit用的是旧数组, 可能还会调用一次
+    // 可调用对象等这些emit都退出后才析构, 所以可以在槽函数里断开自己
+    void disconnect() {
+        if (m_signal != nullptr) {
+            m_disconnect(m_signal, m_id);
+            m_signal = nullptr;
+        }
+    }
+};
+
+// 析构时自动断开的连接
+struct ScopedConnection {
+    Connection m_conn;
+
+    ScopedConnection() = default;
+
+    ScopedConnection(Connection conn) noexcept : m_conn(conn) {}
+
+    ScopedConnection(ScopedConnection &&that) noexcept : m_conn(std::exchange(that.m_conn, Connection())) {}
+
+    ScopedConnection &operator=(ScopedConnection &&that) noexcept {
+        if (this != &that) {
+            m_conn.disconnect();
+            m_conn = std::exchange(that.m_conn, Connection());
+        }
+        return *this;
+    }
+
+    ScopedConnection(ScopedConnection const &) = delete;
+    ScopedConnection &operator=(ScopedConnection const &) = delete;
+
+    ~ScopedConnection() {
+        m_conn.disconnect();
+    }
+
+    bool connected() const noexcept {
+        return m_conn.connected();
+    }
+
+    void disconnect() {
+        m_conn.disconnect();
+    }
+
+    // 放弃所有权, 不再自动断开
+    Connection release() noexcept {
+        return std::exchange(m_conn, Connection());
+    }
+};
+
+template <class FnSig>
+struct Signal {
+    static_assert(!std::is_same_v<FnSig, FnSig>, "Signal only supports void(Args...)");
+};
+
+template <class ...Args>
+struct Signal<void(Args...)> {
+private:
+    // 槽数组的元素是平凡的, 复制数组就是拷贝内存
+    struct Slot {
+        void (*m_invoke)(void *obj, Args &...args);
+        void (*m_destroy)(void *obj) noexcept;
+        void *m_obj;
+        uint64_t m_id;
+    };
+
+    struct SlotList {
+        Vector<Slot> m_slots;
+    };
+
+    // 被替换下来的数组, 以及随之不再可见的槽
+    struct Retired {
+        // 替换时的纪元, 纪元前进到m_epoch + 2之后就没有读者能看到它了
+        uint64_t m_epoch;
+        SlotList *m_list;
+        // 断开的槽, m_obj为空表示没有
+        Slot m_removed;
+        // disconnect_all: 旧数组里的槽全部析构
+        bool m_destroy_all;
+    };
+
+    template <class F>
+    static void do_invoke(void *obj, Args &...args) {
+        (*static_cast<F *>(obj))(args...);
+    }
+
+    template <class F>
+    static void do_destroy(void *obj) noexcept {
+        delete static_cast<F *>(obj);
+    }
+
+    static void do_disconnect(void *signal, uint64_t id) {
+        static_cast<Signal *>(signal)->disconnect(id);
+    }
+
+    std::atomic<SlotList *> m_list{nullptr};
+    // 读者计数分两组, 按当前纪元的奇偶选一组; 写者翻转纪元后只需等旧的一组归零
+    alignas(64) std::atomic<uint64_t> m_epoch{0};
+    alignas(64) mutable std::atomic<size_t> m_readers[2] = {};
+    alignas(64) std::mutex m_write_mutex;
+    uint64_t m_next_id = 1;
+    // 以下由m_write_mutex保护; m_retired_count供emit退出时不加锁地判断要不要帮忙回收
+    Vector<Retired> m_retired;
+    std::atomic<size_t> m_retired_count{0};
+
+    // 进入读临界区, 返回所在的组
+    // 加计数后再检查一次纪元: 如果中途被写者翻转了, 写者可能已经看过这一组的计数, 退出重来
+    size_t read_lock() const noexcept {
+        for (;;) {
+            uint64_t e = m_epoch.load();
+            m_readers[e & 1].fetch_add(1);
+            if (m_epoch.load() == e)
+                return e & 1;
+            m_readers[e & 1].fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    void read_unlock(size_t group) const noexcept {
+        m_readers[group].fetch_sub(1, std::memory_order_release);
+    }
+
+    // 槽函数抛异常时也要退出读临界区, 否则写者会一直等下去
+    struct ReadGuard {
+        Signal const *m_signal;
+        size_t m_group;
+
+        explicit ReadGuard(Signal const *signal) noexcept : m_signal(signal), m_group(signal->read_lock()) {}
+
+        ~ReadGuard() {
+            m_signal->read_unlock(m_group);
+        }
+    };
+
+    // 调用者持有m_write_mutex
+    // 纪元从e前进到e+1之前, 要求(e+1)组里没有读者, 即纪元e-1时进入的读者都已退出
+    // 因此纪元为e时, 读者只可能在e组(纪元e时进入)和(e-1)组(纪元e-1时进入)
+    // 读者是加计数再读纪元, 这里是读计数再写纪元, 都用seq_cst: 要么这里看到读者的计数,
+    // 要么读者复查时看到新纪元, 退出重来
+    bool try_advance() noexcept {
+        uint64_t e = m_epoch.load(std::memory_order_relaxed);
+        if (m_readers[(e + 1) & 1].load(std::memory_order_seq_cst) != 0)
+            return false;
+        m_epoch.store(e + 1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    // 调用者持有m_write_mutex
+    // 纪元e时替换下来的批次, 能看到它的读者在e组和(e-1)组; 纪元前进两次说明这两组都清空过, 可以释放
+    // 能释放的批次移到ready里, 由调用者解锁后再释放: 析构槽函数时可能又会连接/断开这个信号
+    void collect(Vector<Retired> &ready) {
+        if (m_retired.size() == 0)
+            return;
+        while (m_epoch.load(std::memory_order_relaxed) < m_retired[0].m_epoch + 2 && try_advance()) {}
+        uint64_t e = m_epoch.load(std::memory_order_relaxed);
+        size_t n = 0;
+        // 批次按纪元顺序追加, 能释放的是一段前缀
+        while (n != m_retired.size() && m_retired[n].m_epoch + 2 <= e) {
+            ready.push_back(m_retired[n]);
+            ++n;
+        }
+        for (size_t i = n; i != m_retired.size(); i++)
+            m_retired[i - n] = m_retired[i];
+        m_retired.resize(m_retired.size() - n);
+        m_retired_count.store(m_retired.size(), std::memory_order_relaxed);
+    }
+
+    static void free_retired(Vector<Retired> const &ready) noexcept {
+        for (Retired const &r: ready) {
+            if (r.m_destroy_all && r.m_list != nullptr) {
+                for (Slot const &slot: r.m_list->m_slots)
+                    slot.m_destroy(slot.m_obj);
+            }
+            if (r.m_removed.m_obj != nullptr)
+                r.m_removed.m_destroy(r.m_removed.m_obj);
+            delete r.m_list;
+        }
+    }
+
+    // 调用者持有m_write_mutex; 换上新数组, 旧数组连同不再可见的槽挂到待回收列表上
+    void publish(SlotList *list, Slot removed, bool destroy_all, Vector<Retired> &ready) {
+        SlotList *old = m_list.exchange(list, std::memory_order_acq_rel);
+        if (old != nullptr || removed.m_obj != nullptr) {
+            m_retired.push_back(Retired{m_epoch.load(std::memory_order_relaxed), old, removed, destroy_all});
+            m_retired_count.store(m_retired.size(), std::memory_order_relaxed);
+        }
+        collect(ready);
+    }
+
+    // emit退出时调用: 锁被写者占着就不管, 留给它回收
+    void try_reclaim() {
+        Vector<Retired> ready;
+        {
+            std::unique_lock<std::mutex> lock(m_write_mutex, std::try_to_lock);
+            if (!lock.owns_lock())
+                return;
+            collect(ready);
+        }
+        free_retired(ready);
+    }
+
+public:
+    Signal() = default;
+    Signal(Signal const &) = delete;
+    Signal &operator=(Signal const &) = delete;
+
+    // 析构时不能还有线程在emit, 待回收的都可以直接释放
+    ~Signal() {
+        free_retired(m_retired);
+        SlotList *list = m_list.load(std::memory_order_relaxed);
+        if (list != nullptr) {
+            for (Slot const &slot: list->m_slots)
+                slot.m_destroy(slot.m_obj);
+            delete list;
+        }
+    }
+
+    template <class F> requires std::is_invocable_v<std::decay_t<F> &, Args &...>
+    [[nodiscard]] Connection connect(F &&f) {
+        using D = std::decay_t<F>;
+        auto obj = std::make_unique<D>(std::forward<F>(f));
+        Vector<Retired> ready;
+        uint64_t id;
+        {
+            std::lock_guard<std::mutex> guard(m_write_mutex);
+            SlotList *old = m_list.load(std::memory_order_relaxed);
+            auto list = std::make_unique<SlotList>();
+            if (old != nullptr) {
+                list->m_slots.reserve(old->m_slots.size() + 1);
+                for (Slot const &slot: old->m_slots)
+                    list->m_slots.push_back(slot);
+            }
+            id = m_next_id++;
+            list->m_slots.push_back(Slot{&do_invoke<D>, &do_destroy<D>, obj.release(), id});
+            publish(list.release(), Slot{}, false, ready);
+        }
+        free_retired(ready);
+        return Connection(this, &do_disconnect, id);
+    }
+
+    // 返回是否找到了这个槽
+    bool disconnect(uint64_t id) {
+        Vector<Retired> ready;
+        {
+            std::lock_guard<std::mutex> guard(m_write_mutex);
+            SlotList *old = m_list.load(std::memory_order_relaxed);
+            if (old == nullptr)
+                return false;
+            Slot removed{};
+            auto list = std::make_unique<SlotList>();
+            list->m_slots.reserve(old->m_slots.size());
+            for (Slot const &slot: old->m_slots) {
+                if (slot.m_id == id)
+                    removed = slot;
+                else
+                    list->m_slots.push_back(slot);
+            }
+            if (removed.m_obj == nullptr)
+                return false;
+            // 可调用对象跟着旧数组一起等读者退出后再析构
+            publish(list.release(), removed, false, ready);
+        }
+        free_retired(ready);
+        return true;
+    }
+
+    void disconnect_all() {
+        Vector<Retired> ready;
+        {
+            std::lock_guard<std::mutex> guard(m_write_mutex);
+            publish(nullptr, Slot{}, true, ready);
+        }
+        free_retired(ready);
+    }
+
+    // 任意线程都可以调用, 不加锁; 槽函数里可以再emit, 也可以连接/断开
+    // 遍历的是进入时的数组快照, 槽函数里新连接的槽从下一次emit开始才会被调用
+    void emit(Args ...args) {
+        {
+            ReadGuard guard(this);
+            SlotList const *list = m_list.load(std::memory_order_acquire);
+            if (list != nullptr) {
+                for (Slot const &slot: list->m_slots)
+                    slot.m_invoke(slot.m_obj, args...);
+            }
+        }
+        if (m_retired_count.load(std::memory_order_relaxed) != 0) [[unlikely]]
+            try_reclaim();
+    }
+
+    void operator()(Args ...args) {
+        emit(std::forward<Args>(args)...);
+    }
+
+    // 只是一个快照, 并发时仅供参考
+    size_t size() const noexcept {
+        ReadGuard guard(this);
+        SlotList const *list = m_list.load(std::memory_order_acquire);
+        return list != nullptr ? list->m_slots.size() : 0;
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+};
@@ -0,0 +1,137 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Benchmark.hpp"
+#include "SkipListMap.hpp"
+
+void test_ours() {
+    SkipListMap<int, std::string> map;
+    for (int key: {5, 1, 9, 3, 7}) {
+        char value[16];
+        snprintf(value, sizeof value, "v%d", key);
+        map.insert(key, std::string(value));
+    }
+    auto [it, inserted] = map.insert(3, std::string("dup"));
+    printf("insert 3 again: inserted = %d, value = %s\n", inserted, it->second.c_str());
+    for (auto &[key, value]: map) {
+        printf("%d => %s\n", key, value.c_str());
+    }
+    printf("lower_bound(4) = %d, upper_bound(5) = %d, find(8) == end: %d\n",
+           map.lower_bound(4)->first, map.upper_bound(5)->first, map.find(8) == map.end());
+    map.range(3, 8, [] (auto &kv) {
+        printf("range [3, 8): %d\n", kv.first);
+    });
+
+    // 重复插入已有的key: insert先查找不分配, emplace失败的节点留作下一次插入的备用
+    size_t before = map.memory_usage();
+    for (int i = 0; i < 10000; i++) {
+        map.insert(5, std::string("again"));
+        map.emplace(9, std::string("again"));
+    }
+    printf("memory after 20000 duplicate inserts: %zd -> %zd\n", before, map.memory_usage());
+}
+
+// 多个线程并发插入互不相同的key, 检查最终元素个数与有序性
+void test_concurrent_insert(size_t nthreads, size_t per_thread) {
+    SkipListMap<uint64_t, uint64_t> map;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < nthreads; t++) {
+        threads.emplace_back([&, t] {
+            for (size_t i = 0; i < per_thread; i++) {
+                uint64_t key = i * nthreads + t;
+                map.insert(key, key);
+            }
+        });
+    }
+    for (auto &th: threads)
+        th.join();
+    size_t n = 0;
+    bool sorted = true;
+    uint64_t prev = 0;
+    for (auto &kv: map) {
+        if (n != 0 && kv.first <= prev)
+            sorted = false;
+        prev = kv.first;
+        ++n;
+    }
+    printf("concurrent insert: %zd threads, size = %zd, iterated = %zd, sorted = %d\n",
+           nthreads, map.size(), n, sorted);
+}
+
+// 对照组: 读写锁保护的std::map
+struct LockedMap {
+    mutable std::shared_mutex m_mutex;
+    std::map<uint64_t, uint64_t> m_map;
+
+    void insert(uint64_t key, uint64_t value) {
+        std::unique_lock lock(m_mutex);
+        m_map.emplace(key, value);
+    }
+
+    bool contains(uint64_t key) const {
+        std::shared_lock lock(m_mutex);
+        return m_map.find(key) != m_map.end();
+    }
+
+    template <class Visitor>
+    void range(uint64_t lo, uint64_t hi, Visitor visitor) const {
+        std::shared_lock lock(m_mutex);
+        for (auto it = m_map.lower_bound(lo); it != m_map.end() && it->first < hi; ++it)
+            visitor(*it);
+    }
+};
+
+// readers个线程做点查和短区间扫描, writers个线程插入新key
+template <class Map>
+void bench_mixed(char const *name, size_t readers, size_t writers, size_t ops_per_thread) {
+    Map map;
+    uint64_t key_space = ops_per_thread * 16;
+    std::mt19937_64 rng(1);
+    for (size_t i = 0; i < ops_per_thread; i++) {
+        uint64_t key = rng() % key_space;
+        map.insert(key, key);
+    }
+    char label[96];
+    snprintf(label, sizeof label, "%s %zdR/%zdW", name, readers, writers);
+    benchmark(label, [&] {
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < readers + writers; t++) {
+            bool is_writer = t < writers;
+            threads.emplace_back([&, t, is_writer] {
+                std::mt19937_64 rng(t + 100);
+                uint64_t sum = 0;
+                for (size_t i = 0; i < ops_per_thread; i++) {
+                    uint64_t key = rng() % key_space;
+                    if (is_writer) {
+                        map.insert(key, key);
+                    } else if (i % 8 == 0) {
+                        map.range(key, key + 64, [&] (auto &kv) { sum += kv.second; });
+                    } else {
+                        sum += map.contains(key);
+                    }
+                }
+                doNotOptimize(sum);
+            });
+        }
+        for (auto &th: threads)
+            th.join();
+    }, (readers + writers) * ops_per_thread);
+}
+
+int main() {
+    test_ours();
+    test_concurrent_insert(4, 100000);
+    size_t ops = 200000;
+    for (auto [readers, writers]: {std::pair<size_t, size_t>{1, 1}, {3, 1}, {6, 2}, {4, 4}}) {
+        bench_mixed<SkipListMap<uint64_t, uint64_t>>("SkipListMap", readers, writers, ops);
+        bench_mixed<LockedMap>("std::map + shared_mutex", readers, writers, ops);
+    }
+    return 0;
+}
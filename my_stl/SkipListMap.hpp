@@ -0,0 +1,420 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <tuple>
+#include <utility>
+
+// 只增不删的内存池: 节点一旦发布就一直活到容器析构, 读者不需要任何回收机制
+// 分配是一次fetch_add, 只有换新块时才加锁
+struct SkipListArena {
+    static constexpr size_t kBlockSize = 64 * 1024;
+    static constexpr size_t kAlign = alignof(std::max_align_t);
+
+    struct Block {
+        Block *m_prev;
+        size_t m_capacity;
+        std::atomic<size_t> m_used;
+
+        char *data() noexcept {
+            return reinterpret_cast<char *>(this) + header_size();
+        }
+    };
+
+    std::atomic<Block *> m_current;
+    std::mutex m_mutex;
+
+    SkipListArena() {
+        m_current.store(new_block(nullptr, kBlockSize), std::memory_order_relaxed);
+    }
+
+    SkipListArena(SkipListArena const &) = delete;
+    SkipListArena &operator=(SkipListArena const &) = delete;
+
+    ~SkipListArena() noexcept {
+        Block *b = m_current.load(std::memory_order_relaxed);
+        while (b != nullptr) {
+            Block *prev = b->m_prev;
+            ::operator delete(b);
+            b = prev;
+        }
+    }
+
+    // 线程安全
+    void *allocate(size_t bytes) {
+        bytes = (bytes + kAlign - 1) & ~(kAlign - 1);
+        for (;;) {
+            Block *b = m_current.load(std::memory_order_acquire);
+            size_t offset = b->m_used.fetch_add(bytes, std::memory_order_relaxed);
+            if (offset + bytes <= b->m_capacity) [[likely]]
+                return b->data() + offset;
+            std::lock_guard lock(m_mutex);
+            if (m_current.load(std::memory_order_relaxed) == b)
+                m_current.store(new_block(b, std::max(kBlockSize, bytes)), std::memory_order_release);
+        }
+    }
+
+    // 已经分出去的字节数, 并发分配时是近似值
+    size_t memory_usage() const noexcept {
+        size_t total = 0;
+        for (Block *b = m_current.load(std::memory_order_acquire); b != nullptr; b = b->m_prev)
+            total += std::min(b->m_used.load(std::memory_order_relaxed), b->m_capacity);
+        return total;
+    }
+
+private:
+    static constexpr size_t header_size() noexcept {
+        return (sizeof(Block) + kAlign - 1) & ~(kAlign - 1);
+    }
+
+    static Block *new_block(Block *prev, size_t capacity) {
+        void *p = ::operator new(header_size() + capacity);
+        Block *b = ::new (p) Block;
+        b->m_prev = prev;
+        b->m_capacity = capacity;
+        b->m_used.store(0, std::memory_order_relaxed);
+        return b;
+    }
+};
+
+// 跳表有序map: List的节点串成多层, 第i层跳过大约4^i个元素, 查找O(log n)
+// 节点的塔(每层的next指针)和节点本身在内存池里一次分配, 紧挨着存放
+// Concurrent为true时插入用CAS链接, 多个线程可以同时insert/find/遍历, 全程无锁
+// Concurrent为false时只允许单个写者(仍然可以有并发读者), 链接用普通的release写
+// 不支持erase: 没有删除, 读者就永远不会看到被释放的节点
+template <class K, class V, class Compare = std::less<K>, bool Concurrent = true>
+struct SkipListMap {
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K const, V>;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using reference = value_type &;
+    using const_reference = value_type const &;
+
+    static constexpr int kMaxHeight = 16;
+
+private:
+    struct Node {
+        value_type m_kv;
+        int m_height;
+        std::atomic<Node *> m_next[1];
+        // 实际分配m_height个next, 超出数组声明部分在分配时额外留出(同LevelDB的做法)
+
+        template <class ...Args>
+        Node(int height, Args &&...args) : m_kv(std::forward<Args>(args)...), m_height(height) {
+            for (int i = 1; i < height; i++)
+                ::new (&m_next[i]) std::atomic<Node *>(nullptr);
+            m_next[0].store(nullptr, std::memory_order_relaxed);
+        }
+
+        Node *next(int level) const noexcept {
+            return m_next[level].load(std::memory_order_acquire);
+        }
+
+        static size_t bytes(int height) noexcept {
+            return sizeof(Node) + (height - 1) * sizeof(std::atomic<Node *>);
+        }
+    };
+
+    // 头节点只需要塔, 不需要键值
+    struct Head {
+        std::atomic<Node *> m_next[kMaxHeight];
+    };
+
+    // 每个map一个不重复的编号, 线程缓存的备用节点按编号认领, map析构后旧的缓存自然作废
+    static inline std::atomic<uint64_t> s_next_id{1};
+
+    // 插入竞争失败的节点内存留给本线程下一次插入, 不然每次失败都在池子里漏掉一个节点
+    struct Spare {
+        uint64_t m_owner = 0;
+        void *m_memory = nullptr;
+        int m_height = 0;
+    };
+
+    Head m_head;
+    uint64_t m_id;
+    std::atomic<int> m_max_height;
+    std::atomic<size_t> m_size;
+    SkipListArena m_arena;
+    [[no_unique_address]] Compare m_comp;
+
+public:
+    struct iterator {
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = SkipListMap::value_type;
+        using difference_type = ptrdiff_t;
+        using pointer = value_type *;
+        using reference = value_type &;
+
+        Node *curr = nullptr;
+
+        iterator &operator++() noexcept {
+            curr = curr->next(0);
+            return *this;
+        }
+
+        iterator operator++(int) noexcept {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        value_type &operator*() const noexcept {
+            return curr->m_kv;
+        }
+
+        value_type *operator->() const noexcept {
+            return &curr->m_kv;
+        }
+
+        bool operator==(iterator const &that) const noexcept {
+            return curr == that.curr;
+        }
+
+        bool operator!=(iterator const &that) const noexcept {
+            return curr != that.curr;
+        }
+    };
+
+    SkipListMap() : m_id(s_next_id.fetch_add(1, std::memory_order_relaxed)), m_max_height(1), m_size(0) {
+        for (int i = 0; i < kMaxHeight; i++)
+            m_head.m_next[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    SkipListMap(SkipListMap const &) = delete;
+    SkipListMap &operator=(SkipListMap const &) = delete;
+
+    ~SkipListMap() noexcept {
+        Node *p = m_head.m_next[0].load(std::memory_order_relaxed);
+        while (p != nullptr) {
+            Node *next = p->m_next[0].load(std::memory_order_relaxed);
+            std::destroy_at(p);
+            p = next;
+        }
+    }
+
+    iterator begin() const noexcept {
+        return iterator{m_head.m_next[0].load(std::memory_order_acquire)};
+    }
+
+    iterator end() const noexcept {
+        return iterator{nullptr};
+    }
+
+    // 并发插入时只是一个近似值
+    size_t size() const noexcept {
+        return m_size.load(std::memory_order_relaxed);
+    }
+
+    // 节点占用的池内存, 只增不减
+    size_t memory_usage() const noexcept {
+        return m_arena.memory_usage();
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    // 第一个不小于key的元素
+    iterator lower_bound(K const &key) const {
+        return iterator{find_greater_or_equal(key, nullptr, nullptr)};
+    }
+
+    iterator upper_bound(K const &key) const {
+        iterator it = lower_bound(key);
+        while (it.curr != nullptr && !m_comp(key, it->first))
+            ++it;
+        return it;
+    }
+
+    iterator find(K const &key) const {
+        Node *node = find_greater_or_equal(key, nullptr, nullptr);
+        if (node != nullptr && !m_comp(key, node->m_kv.first))
+            return iterator{node};
+        return end();
+    }
+
+    bool contains(K const &key) const {
+        return find(key) != end();
+    }
+
+    // 遍历[lo, hi)中的元素, 与插入并发时能看到遍历开始后插入的部分元素
+    template <class Visitor>
+    void range(K const &lo, K const &hi, Visitor visitor) const {
+        for (iterator it = lower_bound(lo); it.curr != nullptr && m_comp(it->first, hi); ++it)
+            visitor(*it);
+    }
+
+    // key已存在时不覆盖, 返回已有元素和false, 同std::map::insert
+    template <class VV>
+    std::pair<iterator, bool> insert(K const &key, VV &&value) {
+        return try_emplace(key, std::forward<VV>(value));
+    }
+
+    template <class VV>
+    std::pair<iterator, bool> insert(K &&key, VV &&value) {
+        return try_emplace(std::move(key), std::forward<VV>(value));
+    }
+
+    // 先查找, key不存在时才分配节点, 重复插入已有的key不占池内存
+    template <class ...Args>
+    std::pair<iterator, bool> try_emplace(K const &key, Args &&...args) {
+        return try_emplace_impl(key, std::forward<Args>(args)...);
+    }
+
+    template <class ...Args>
+    std::pair<iterator, bool> try_emplace(K &&key, Args &&...args) {
+        return try_emplace_impl(std::move(key), std::forward<Args>(args)...);
+    }
+
+    // 要先构造出节点才知道key, key已存在时节点内存留作本线程的备用节点
+    template <class ...Args>
+    std::pair<iterator, bool> emplace(Args &&...args) {
+        Node *node = new_node(std::forward<Args>(args)...);
+        Node *preds[kMaxHeight];
+        Node *succs[kMaxHeight];
+        Node *found = find_greater_or_equal(node->m_kv.first, preds, succs);
+        if (found != nullptr && !m_comp(node->m_kv.first, found->m_kv.first))
+            return discard(node, found);
+        return link_node(node, preds, succs);
+    }
+
+private:
+    template <class KK, class ...Args>
+    std::pair<iterator, bool> try_emplace_impl(KK &&key, Args &&...args) {
+        Node *preds[kMaxHeight];
+        Node *succs[kMaxHeight];
+        Node *found = find_greater_or_equal(key, preds, succs);
+        if (found != nullptr && !m_comp(key, found->m_kv.first))
+            return {iterator{found}, false};
+        Node *node = new_node(std::piecewise_construct, std::forward_as_tuple(std::forward<KK>(key)),
+                              std::forward_as_tuple(std::forward<Args>(args)...));
+        return link_node(node, preds, succs);
+    }
+
+    // preds/succs是刚才查找时记下的位置, 竞争失败时重新定位
+    std::pair<iterator, bool> link_node(Node *node, Node **preds, Node **succs) {
+        K const &key = node->m_kv.first;
+        int height = node->m_height;
+        raise_max_height(height);
+        // 先挂到第0层: 挂上之后节点就算插入成功了, 上层只是加速查找的索引
+        for (;;) {
+            node->m_next[0].store(succs[0], std::memory_order_relaxed);
+            if (link(preds[0], 0, succs[0], node))
+                break;
+            // 有别的写者插在了同一个位置, 重新定位
+            Node *found = find_greater_or_equal(key, preds, succs);
+            if (found != nullptr && !m_comp(key, found->m_kv.first))
+                return discard(node, found);
+        }
+        for (int level = 1; level < height; level++) {
+            for (;;) {
+                node->m_next[level].store(succs[level], std::memory_order_relaxed);
+                if (link(preds[level], level, succs[level], node))
+                    break;
+                find_greater_or_equal(key, preds, succs);
+            }
+        }
+        m_size.fetch_add(1, std::memory_order_relaxed);
+        return {iterator{node}, true};
+    }
+
+    static Spare &spare() noexcept {
+        thread_local Spare s;
+        return s;
+    }
+
+    // 本线程有这个map的备用节点就用它, 塔高不超过备用节点的高度
+    // 只有插入竞争失败之后的那一次会压低高度, 对高度分布的影响可以忽略
+    template <class ...Args>
+    Node *new_node(Args &&...args) {
+        int height = random_height();
+        void *memory;
+        Spare &s = spare();
+        if (s.m_owner == m_id) {
+            s.m_owner = 0;
+            height = std::min(height, s.m_height);
+            memory = s.m_memory;
+        } else {
+            memory = m_arena.allocate(Node::bytes(height));
+        }
+        return ::new (memory) Node(height, std::forward<Args>(args)...);
+    }
+
+    std::atomic<Node *> &next_of(Node *node, int level) const noexcept {
+        if (node == nullptr)
+            return const_cast<Head &>(m_head).m_next[level];
+        return node->m_next[level];
+    }
+
+    // 从最高层往下找第一个>=key的节点, 顺便记下每层的前驱和后继
+    // 前驱为nullptr表示头节点
+    Node *find_greater_or_equal(K const &key, Node **preds, Node **succs) const {
+        int top = m_max_height.load(std::memory_order_acquire);
+        Node *pred = nullptr;
+        Node *next = nullptr;
+        for (int level = kMaxHeight - 1; level >= 0; level--) {
+            if (level < top) {
+                next = next_of(pred, level).load(std::memory_order_acquire);
+                while (next != nullptr && m_comp(next->m_kv.first, key)) {
+                    pred = next;
+                    next = next->next(level);
+                }
+            } else {
+                next = nullptr;
+            }
+            if (preds != nullptr) {
+                preds[level] = pred;
+                succs[level] = next;
+            }
+        }
+        return next;
+    }
+
+    bool link(Node *pred, int level, Node *&expected, Node *node) noexcept {
+        std::atomic<Node *> &slot = next_of(pred, level);
+        if constexpr (Concurrent) {
+            return slot.compare_exchange_strong(expected, node, std::memory_order_release, std::memory_order_acquire);
+        } else {
+            // 单写者: 前驱的next不会被别人改, 直接发布
+            slot.store(node, std::memory_order_release);
+            return true;
+        }
+    }
+
+    void raise_max_height(int height) noexcept {
+        int top = m_max_height.load(std::memory_order_relaxed);
+        while (height > top && !m_max_height.compare_exchange_weak(top, height, std::memory_order_acq_rel)) {
+        }
+    }
+
+    // 插入失败的节点还没有发布, 直接析构, 内存留给本线程下一次插入
+    // 缓存里原来的备用节点只可能是别的map的(本map的在new_node里已经取走了), 直接覆盖
+    std::pair<iterator, bool> discard(Node *node, Node *found) noexcept {
+        spare() = Spare{m_id, node, node->m_height};
+        std::destroy_at(node);
+        return {iterator{found}, false};
+    }
+
+    // 每层以1/4的概率继续长高, 每个线程一个xorshift状态, 不需要同步
+    static int random_height() noexcept {
+        thread_local uint64_t state = 0x9e3779b97f4a7c15ULL ^ (uint64_t)(uintptr_t)&state;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        uint64_t bits = state;
+        int height = 1;
+        while (height < kMaxHeight && (bits & 3) == 0) {
+            ++height;
+            bits >>= 2;
+        }
+        return height;
+    }
+};
@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "Benchmark.hpp"
+#include "ThreadPool.hpp"
+
+void test_ours() {
+    ThreadPool pool(4);
+    auto answer = pool.submit([] { return 6 * 7; });
+    auto nothing = pool.submit([] {});
+    auto fails = pool.submit([] () -> int { throw std::runtime_error("task failed"); });
+    printf("answer = %d\n", answer.get());
+    nothing.get();
+    try {
+        fails.get();
+    } catch (std::runtime_error const &e) {
+        printf("exception: %s\n", e.what());
+    }
+
+    // 任务里再提交任务并等待: 等待的worker会帮着执行, 不会死锁
+    auto nested = pool.submit([&pool] {
+        auto a = pool.submit([] { return 1; });
+        auto b = pool.submit([] { return 2; });
+        return a.get() + b.get();
+    });
+    printf("nested = %d\n", nested.get());
+
+    std::vector<uint64_t> squares(1000);
+    pool.parallel_for(0, squares.size(), [&] (size_t i) { squares[i] = i * i; });
+    uint64_t sum = 0;
+    for (uint64_t x: squares)
+        sum += x;
+    printf("parallel_for sum of squares = %lu\n", (unsigned long)sum);
+    try {
+        pool.parallel_for(0, 100, [] (size_t i) {
+            if (i == 42)
+                throw std::out_of_range("i == 42");
+        });
+    } catch (std::out_of_range const &e) {
+        printf("parallel_for exception: %s\n", e.what());
+    }
+
+    // 绑核只在Linux上生效, 核数不够时按核数取模
+    ThreadPool pinned(2, true);
+    printf("pinned pool: %d\n", pinned.submit([] { return 1; }).get());
+}
+
+// 对照: 一把锁加条件变量保护的std::queue<std::function>, 所有worker共用
+struct SimplePool {
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::queue<std::function<void()>> m_tasks;
+    std::vector<std::thread> m_threads;
+    bool m_stop = false;
+
+    explicit SimplePool(size_t threads) {
+        for (size_t i = 0; i < threads; i++) {
+            m_threads.emplace_back([this] {
+                for (;;) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+                        m_cv.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+                        if (m_tasks.empty())
+                            return;
+                        task = std::move(m_tasks.front());
+                        m_tasks.pop();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+
+    ~SimplePool() {
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        for (auto &t: m_threads)
+            t.join();
+    }
+
+    size_t size() const noexcept {
+        return m_threads.size();
+    }
+
+    template <class F>
+    void post(F f) {
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            m_tasks.emplace(std::move(f));
+        }
+        m_cv.notify_one();
+    }
+};
+
+// 提交一个空任务, 等它执行完再提交下一个: 包含唤醒睡眠worker的开销
+template <class Pool>
+void bench_latency(char const *name, Pool &pool, size_t n) {
+    std::atomic<uint32_t> done{0};
+    benchmark(name, [&] {
+        for (size_t i = 0; i < n; i++) {
+            done.store(0, std::memory_order_relaxed);
+            pool.post([&done] {
+                done.store(1, std::memory_order_release);
+                done.notify_one();
+            });
+            while (done.load(std::memory_order_acquire) == 0)
+                done.wait(0, std::memory_order_acquire);
+        }
+    }, n);
+}
+
+// 从外部一口气提交n个小任务, 等全部执行完
+template <class Pool>
+void bench_throughput(char const *name, Pool &pool, size_t n) {
+    std::atomic<size_t> remaining{n};
+    std::atomic<uint64_t> sum{0};
+    benchmark(name, [&] {
+        for (size_t i = 0; i < n; i++) {
+            pool.post([&remaining, &sum, i] {
+                sum.fetch_add(i, std::memory_order_relaxed);
+                if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    remaining.notify_one();
+            });
+        }
+        for (size_t left; (left = remaining.load(std::memory_order_acquire)) != 0;)
+            remaining.wait(left, std::memory_order_acquire);
+    }, n);
+    doNotOptimize(sum.load());
+}
+
+// 任务里再分出两个子任务, 直到depth层: 子任务进提交者自己的本地队列
+template <class Pool>
+void spawn_tree(Pool &pool, std::atomic<size_t> &remaining, int depth) {
+    if (depth > 0) {
+        pool.post([&pool, &remaining, depth] { spawn_tree(pool, remaining, depth - 1); });
+        pool.post([&pool, &remaining, depth] { spawn_tree(pool, remaining, depth - 1); });
+    }
+    if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        remaining.notify_one();
+}
+
+template <class Pool>
+void bench_spawn(char const *name, Pool &pool, int depth) {
+    size_t n = (size_t(1) << (depth + 1)) - 1;
+    std::atomic<size_t> remaining{n};
+    benchmark(name, [&] {
+        pool.post([&] { spawn_tree(pool, remaining, depth); });
+        for (size_t left; (left = remaining.load(std::memory_order_acquire)) != 0;)
+            remaining.wait(left, std::memory_order_acquire);
+    }, n);
+}
+
+void bench_parallel_for(ThreadPool &pool, size_t n) {
+    std::vector<uint32_t> data(n);
+    benchmark("parallel_for fill", [&] {
+        pool.parallel_for(0, n, [&] (size_t i) { data[i] = (uint32_t)(i * 2654435761u); });
+    }, n);
+    benchmark("serial fill", [&] {
+        for (size_t i = 0; i < n; i++)
+            data[i] = (uint32_t)(i * 2654435761u);
+        doNotOptimize(data.data());
+    }, n);
+}
+
+int main() {
+    test_ours();
+    size_t threads = std::max(2u, std::thread::hardware_concurrency());
+    ThreadPool pool(threads);
+    SimplePool simple(threads);
+    printf("== %zd workers, submit-to-run latency ==\n", threads);
+    bench_latency("ThreadPool", pool, 1 << 14);
+    bench_latency("mutex + condition_variable pool", simple, 1 << 14);
+    printf("== throughput, small tasks posted from outside ==\n");
+    bench_throughput("ThreadPool", pool, 1 << 20);
+    bench_throughput("mutex + condition_variable pool", simple, 1 << 20);
+    printf("== throughput, tasks spawning tasks ==\n");
+    bench_spawn("ThreadPool", pool, 19);
+    bench_spawn("mutex + condition_variable pool", simple, 19);
+    printf("== parallel_for ==\n");
+    bench_parallel_for(pool, 1 << 24);
+    return 0;
+}
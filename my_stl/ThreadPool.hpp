@@ -0,0 +1,384 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include "ChaseLevDeque.hpp"
+#include "Deque.hpp"
+#include "Function.hpp"
+#include "Optional.hpp"
+#include "SharedPtr.hpp"
+#include "Vector.hpp"
+
+// 工作窃取线程池: 每个worker有自己的ChaseLevDeque, 自己从底部push/pop, 空闲的worker从别人的顶部偷
+// 不在worker线程里提交的任务放进一个加锁的全局注入队列
+// 找不到任务的worker先自旋几轮, 再在一个原子计数器上atomic::wait睡眠(Linux上就是futex), 提交任务时唤醒
+
+namespace thread_pool_detail {
+
+// 任务的返回值或异常, submit返回的TaskHandle和任务本身共享
+template <class T>
+struct SharedState {
+    struct Void {};
+    using Value = std::conditional_t<std::is_void_v<T>, Void, T>;
+
+    Optional<Value> m_value;
+    std::exception_ptr m_exception;
+    std::atomic<uint32_t> m_ready{0};
+
+    void finish() noexcept {
+        m_ready.store(1, std::memory_order_release);
+        m_ready.notify_all();
+    }
+};
+
+} // namespace thread_pool_detail
+
+struct ThreadPool;
+
+// 类似std::future: 可以等待任务完成并取出结果, 任务抛出的异常在get()时重新抛出
+// 在worker线程里等待时, 会先帮着执行别的任务, 不会把整个池子卡死
+template <class T>
+struct TaskHandle {
+    SharedPtr<thread_pool_detail::SharedState<T>> m_state;
+    ThreadPool *m_pool = nullptr;
+
+    TaskHandle() = default;
+
+    TaskHandle(SharedPtr<thread_pool_detail::SharedState<T>> state, ThreadPool *pool) noexcept
+        : m_state(std::move(state)), m_pool(pool) {}
+
+    bool valid() const noexcept {
+        return m_state != nullptr;
+    }
+
+    bool ready() const noexcept {
+        return m_state->m_ready.load(std::memory_order_acquire) != 0;
+    }
+
+    void wait() const;
+
+    // 只能调用一次
+    T get() {
+        wait();
+        auto state = std::move(m_state);
+        // 异常移出共享状态, 任务那边最后释放共享状态时就不会碰到它
+        if (state->m_exception)
+            std::rethrow_exception(std::move(state->m_exception));
+        if constexpr (!std::is_void_v<T>)
+            return std::move(*state->m_value);
+    }
+};
+
+struct ThreadPool {
+private:
+    // 用MoveOnlyFunction而不是Function: submit把用户的可调用对象移进闭包, 它可能只能移动(比如捕获了UniquePtr)
+    struct Task {
+        MoveOnlyFunction<void()> m_fn;
+    };
+
+    struct Worker {
+        ThreadPool *m_pool;
+        ChaseLevDeque<Task *> m_local;
+        std::thread m_thread;
+        uint64_t m_rng;
+    };
+
+    Vector<std::unique_ptr<Worker>> m_workers;
+    std::mutex m_inject_mutex;
+    Deque<Task *> m_inject;
+    // 无锁地判断全局队列是否为空, 真正出队时还要加锁
+    alignas(64) std::atomic<size_t> m_inject_size{0};
+    // 每次提交任务加一, 睡眠的worker在它上面wait
+    alignas(64) std::atomic<uint32_t> m_wake{0};
+    std::atomic<uint32_t> m_sleepers{0};
+    std::atomic<bool> m_stop{false};
+    // 还没执行完的任务数, 析构时等它归零
+    alignas(64) std::atomic<size_t> m_pending{0};
+
+    static constexpr int kSpinRounds = 64;
+
+    // 当前线程所在的worker, 不是worker线程时为nullptr
+    static Worker *&current_worker() noexcept {
+        static thread_local Worker *worker = nullptr;
+        return worker;
+    }
+
+    Worker *local_worker() const noexcept {
+        Worker *w = current_worker();
+        return (w != nullptr && w->m_pool == this) ? w : nullptr;
+    }
+
+    void push_task(Task *task) {
+        m_pending.fetch_add(1, std::memory_order_relaxed);
+        if (Worker *w = local_worker()) {
+            w->m_local.push(task);
+        } else {
+            std::lock_guard<std::mutex> guard(m_inject_mutex);
+            m_inject.push_back(task);
+            m_inject_size.fetch_add(1, std::memory_order_relaxed);
+        }
+        wake_one();
+    }
+
+    // 与park里先登记再检查的顺序配对, 不会丢失唤醒
+    void wake_one() noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_sleepers.load(std::memory_order_relaxed) != 0) {
+            m_wake.fetch_add(1, std::memory_order_release);
+            m_wake.notify_one();
+        }
+    }
+
+    Task *pop_inject() {
+        if (m_inject_size.load(std::memory_order_relaxed) == 0)
+            return nullptr;
+        std::lock_guard<std::mutex> guard(m_inject_mutex);
+        if (m_inject.empty())
+            return nullptr;
+        Task *task = m_inject.front();
+        m_inject.pop_front();
+        m_inject_size.fetch_sub(1, std::memory_order_relaxed);
+        return task;
+    }
+
+    // 从随机的一个worker开始依次尝试偷一个任务
+    Task *steal(Worker *self) {
+        size_t n = m_workers.size();
+        uint64_t start = 0;
+        if (self != nullptr) {
+            self->m_rng ^= self->m_rng << 13;
+            self->m_rng ^= self->m_rng >> 7;
+            self->m_rng ^= self->m_rng << 17;
+            start = self->m_rng;
+        }
+        for (size_t k = 0; k < n; k++) {
+            Worker *victim = m_workers[(start + k) % n].get();
+            if (victim == self)
+                continue;
+            if (auto task = victim->m_local.steal())
+                return *task;
+        }
+        return nullptr;
+    }
+
+    // 本地队列, 全局队列, 偷别人, 依次尝试
+    Task *find_task(Worker *self) {
+        if (self != nullptr) {
+            if (auto task = self->m_local.pop())
+                return *task;
+        }
+        if (Task *task = pop_inject())
+            return task;
+        return steal(self);
+    }
+
+    bool has_visible_work() const noexcept {
+        if (m_inject_size.load(std::memory_order_relaxed) != 0)
+            return true;
+        for (auto const &w: m_workers) {
+            if (!w->m_local.empty())
+                return true;
+        }
+        return false;
+    }
+
+    void run(Task *task) noexcept {
+        task->m_fn();
+        delete task;
+        m_pending.fetch_sub(1, std::memory_order_release);
+    }
+
+    // 先登记为睡眠者再检查队列, 提交者先入队再看有没有睡眠者, 两边至少有一方能看到对方
+    void park() {
+        m_sleepers.fetch_add(1, std::memory_order_relaxed);
+        uint32_t wake = m_wake.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!has_visible_work() && !m_stop.load(std::memory_order_acquire))
+            m_wake.wait(wake, std::memory_order_acquire);
+        m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void worker_main(Worker *self) {
+        current_worker() = self;
+        int idle = 0;
+        for (;;) {
+            if (Task *task = find_task(self)) {
+                run(task);
+                idle = 0;
+                continue;
+            }
+            if (m_stop.load(std::memory_order_acquire) && m_pending.load(std::memory_order_acquire) == 0)
+                break;
+            if (++idle < kSpinRounds) {
+                std::this_thread::yield();
+                continue;
+            }
+            park();
+            idle = 0;
+        }
+        current_worker() = nullptr;
+    }
+
+    static void pin_to_cpu(std::thread &thread, size_t cpu) noexcept {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        // hardware_concurrency()允许返回0(未知), 同构造函数里threads == 0的处理
+        CPU_SET(cpu % std::max(1u, std::thread::hardware_concurrency()), &set);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+        (void)thread;
+        (void)cpu;
+#endif
+    }
+
+public:
+    // pin为true时第i个worker绑定到第i个CPU上(只在Linux上生效)
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency(), bool pin = false) {
+        if (threads == 0)
+            threads = 1;
+        m_workers.reserve(threads);
+        for (size_t i = 0; i < threads; i++)
+            m_workers.push_back(std::unique_ptr<Worker>(new Worker{this, ChaseLevDeque<Task *>(), std::thread(), 0x9e3779b97f4a7c15ull * (i + 1)}));
+        for (size_t i = 0; i < threads; i++) {
+            Worker *w = m_workers[i].get();
+            w->m_thread = std::thread([this, w] { worker_main(w); });
+            if (pin)
+                pin_to_cpu(w->m_thread, i);
+        }
+    }
+
+    ThreadPool(ThreadPool const &) = delete;
+    ThreadPool &operator=(ThreadPool const &) = delete;
+
+    // 等已经提交的任务全部执行完再退出
+    ~ThreadPool() {
+        m_stop.store(true, std::memory_order_release);
+        m_wake.fetch_add(1, std::memory_order_release);
+        m_wake.notify_all();
+        for (auto &w: m_workers)
+            w->m_thread.join();
+    }
+
+    size_t size() const noexcept {
+        return m_workers.size();
+    }
+
+    // 不关心结果的任务, 省掉共享状态的分配; 任务抛出异常会终止程序, 需要结果或异常时用submit
+    template <class F>
+    void post(F &&f) {
+        push_task(new Task{MoveOnlyFunction<void()>(std::forward<F>(f))});
+    }
+
+    template <class F, class R = std::invoke_result_t<std::decay_t<F> &>>
+    TaskHandle<R> submit(F &&f) {
+        auto state = makeShared<thread_pool_detail::SharedState<R>>();
+        post([state, f = std::forward<F>(f)] () mutable {
+            try {
+                if constexpr (std::is_void_v<R>) {
+                    f();
+                    state->m_value.emplace();
+                } else {
+                    state->m_value.emplace(f());
+                }
+            } catch (...) {
+                state->m_exception = std::current_exception();
+            }
+            state->finish();
+        });
+        return TaskHandle<R>(std::move(state), this);
+    }
+
+    // 在当前线程执行一个排队中的任务, 没有任务时返回false; 等待时用来帮忙
+    bool run_one() {
+        if (Task *task = find_task(local_worker())) {
+            run(task);
+            return true;
+        }
+        return false;
+    }
+
+    // 对[begin, end)里的每个i调用body(i), 所有调用结束后返回
+    // 区间按grain切块, 调用者和最多size()个worker一起按原子计数器领取, 不为每块单独分配任务
+    // 第一个抛出的异常会在所有块结束后重新抛出
+    template <class Body>
+    void parallel_for(size_t begin, size_t end, Body const &body, size_t grain = 0) {
+        if (begin >= end)
+            return;
+        size_t n = end - begin;
+        if (grain == 0)
+            grain = std::max<size_t>(1, n / (size() * 8));
+        size_t chunks = (n + grain - 1) / grain;
+        struct Shared {
+            std::atomic<size_t> m_next{0};
+            std::atomic<size_t> m_done{0};
+            std::atomic<bool> m_failed{false};
+            std::exception_ptr m_exception;
+        };
+        auto shared = makeShared<Shared>();
+        // 领取块直到领完, body的地址在所有块结束前一直有效
+        auto work = [shared, &body, begin, end, grain, chunks] {
+            for (;;) {
+                size_t c = shared->m_next.fetch_add(1, std::memory_order_relaxed);
+                if (c >= chunks)
+                    return;
+                size_t lo = begin + c * grain;
+                size_t hi = std::min(end, lo + grain);
+                if (!shared->m_failed.load(std::memory_order_relaxed)) {
+                    try {
+                        for (size_t i = lo; i < hi; i++)
+                            body(i);
+                    } catch (...) {
+                        if (!shared->m_failed.exchange(true))
+                            shared->m_exception = std::current_exception();
+                    }
+                }
+                if (shared->m_done.fetch_add(1, std::memory_order_acq_rel) + 1 == chunks)
+                    shared->m_done.notify_all();
+            }
+        };
+        size_t helpers = std::min(size(), chunks - 1);
+        for (size_t i = 0; i < helpers; i++)
+            post(work);
+        work();
+        // 自己领完了, 等别人手上的块; worker线程里等待时先帮忙跑别的任务
+        for (;;) {
+            size_t done = shared->m_done.load(std::memory_order_acquire);
+            if (done == chunks)
+                break;
+            if (local_worker() != nullptr && run_one())
+                continue;
+            shared->m_done.wait(done, std::memory_order_acquire);
+        }
+        if (shared->m_exception)
+            std::rethrow_exception(std::move(shared->m_exception));
+    }
+
+    template <class T>
+    friend struct TaskHandle;
+};
+
+template <class T>
+void TaskHandle<T>::wait() const {
+    auto &ready = m_state->m_ready;
+    if (m_pool != nullptr && m_pool->local_worker() != nullptr) {
+        while (ready.load(std::memory_order_acquire) == 0) {
+            if (!m_pool->run_one())
+                std::this_thread::yield();
+        }
+        return;
+    }
+    while (ready.load(std::memory_order_acquire) == 0)
+        ready.wait(0, std::memory_order_acquire);
+}
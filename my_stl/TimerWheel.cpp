@@ -0,0 +1,168 @@
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+#include "Benchmark.hpp"
+#include "TimerWheel.hpp"
+
+void test_ours() {
+    TimerWheel wheel;
+    std::vector<int> order;
+    wheel.schedule(5, [&] { order.push_back(5); });
+    wheel.schedule(300, [&] { order.push_back(300); });
+    wheel.schedule(70000, [&] { order.push_back(70000); });
+    // 超出2^26个tick的范围, 会在最高层多转几圈
+    wheel.schedule(100000000, [&] { order.push_back(100000000); });
+    TimerHandle h = wheel.schedule(10, [&] { order.push_back(10); });
+    printf("pending = %d, size = %zd\n", wheel.pending(h), wheel.size());
+    bool first = wheel.cancel(h);
+    bool again = wheel.cancel(h);
+    printf("cancel = %d, cancel again = %d\n", first, again);
+    // 回调里可以再安排定时器
+    wheel.schedule(1, [&] {
+        order.push_back(1);
+        wheel.schedule(2, [&] { order.push_back(3); });
+    });
+    size_t fired = wheel.advance(4);
+    printf("advance(4): fired %zd\n", fired);
+    fired = wheel.advance(100000);
+    printf("advance(100000): fired %zd, left %zd\n", fired, wheel.size());
+    wheel.advance(100000001);
+    printf("order:");
+    for (int x: order)
+        printf(" %d", x);
+    printf("\nnow = %lu, empty = %d\n", (unsigned long)wheel.now(), wheel.empty());
+}
+
+// 对照: 最小堆, 取消时只把槽位标记为作废, 堆里的条目到期弹出时才丢掉
+struct HeapScheduler {
+    struct Entry {
+        uint64_t m_expire;
+        uint32_t m_slot;
+        uint32_t m_generation;
+
+        bool operator>(Entry const &that) const noexcept {
+            return m_expire > that.m_expire;
+        }
+    };
+
+    struct Slot {
+        uint32_t m_generation = 0;
+        std::function<void()> m_callback;
+    };
+
+    struct Handle {
+        uint32_t m_slot;
+        uint32_t m_generation;
+    };
+
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> m_heap;
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_free;
+    uint64_t m_now = 0;
+
+    Handle schedule(uint64_t delay, std::function<void()> callback) {
+        uint32_t slot;
+        if (!m_free.empty()) {
+            slot = m_free.back();
+            m_free.pop_back();
+        } else {
+            slot = (uint32_t)m_slots.size();
+            m_slots.emplace_back();
+        }
+        m_slots[slot].m_callback = std::move(callback);
+        m_heap.push(Entry{m_now + delay, slot, m_slots[slot].m_generation});
+        return Handle{slot, m_slots[slot].m_generation};
+    }
+
+    bool cancel(Handle h) {
+        Slot &slot = m_slots[h.m_slot];
+        if (slot.m_generation != h.m_generation)
+            return false;
+        ++slot.m_generation;
+        slot.m_callback = nullptr;
+        m_free.push_back(h.m_slot);
+        return true;
+    }
+
+    size_t advance(uint64_t now) {
+        m_now = now;
+        size_t fired = 0;
+        while (!m_heap.empty() && m_heap.top().m_expire <= now) {
+            Entry e = m_heap.top();
+            m_heap.pop();
+            Slot &slot = m_slots[e.m_slot];
+            if (slot.m_generation != e.m_generation)
+                continue;
+            auto callback = std::move(slot.m_callback);
+            ++slot.m_generation;
+            m_free.push_back(e.m_slot);
+            ++fired;
+            callback();
+        }
+        return fired;
+    }
+};
+
+// 模拟请求超时: 每个tick发出per_tick个请求, 每个请求安排一个超时
+// 大部分请求在cancel_after个tick后收到回应, 取消超时; 其余的超时触发
+struct Workload {
+    std::vector<uint32_t> m_delays;
+    std::vector<bool> m_cancelled;
+    size_t m_ticks;
+    size_t m_per_tick;
+    size_t m_cancel_after;
+
+    Workload(size_t ticks, size_t per_tick, double cancel_ratio, size_t cancel_after)
+        : m_ticks(ticks), m_per_tick(per_tick), m_cancel_after(cancel_after) {
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<uint32_t> delay(1000, 30000);
+        std::uniform_real_distribution<double> dist(0, 1);
+        for (size_t i = 0; i < ticks * per_tick; i++) {
+            m_delays.push_back(delay(rng));
+            m_cancelled.push_back(dist(rng) < cancel_ratio);
+        }
+    }
+};
+
+template <class Scheduler, class Handle>
+void run_workload(char const *name, Workload const &w) {
+    Scheduler sched;
+    uint64_t fired = 0, sink = 0;
+    size_t total = w.m_ticks * w.m_per_tick;
+    std::vector<Handle> handles(total);
+    benchmark(name, [&] {
+        size_t next = 0;
+        for (size_t t = 1; t <= w.m_ticks; t++) {
+            for (size_t k = 0; k < w.m_per_tick; k++, next++)
+                handles[next] = sched.schedule(w.m_delays[next], [&sink, next] { sink += next; });
+            // 处理cancel_after个tick之前发出的请求的回应
+            if (t > w.m_cancel_after) {
+                size_t first = (t - w.m_cancel_after - 1) * w.m_per_tick;
+                for (size_t i = first; i < first + w.m_per_tick; i++) {
+                    if (w.m_cancelled[i])
+                        sched.cancel(handles[i]);
+                }
+            }
+            fired += sched.advance(t);
+        }
+    }, total);
+    printf("  %zd fired\n", (size_t)fired);
+    doNotOptimize(sink);
+}
+
+void bench_timeouts(double cancel_ratio) {
+    Workload w(1 << 16, 16, cancel_ratio, 20);
+    printf("== %zd timeouts, %.0f%% cancelled ==\n", w.m_ticks * w.m_per_tick, cancel_ratio * 100);
+    run_workload<TimerWheel, TimerHandle>("TimerWheel", w);
+    run_workload<HeapScheduler, HeapScheduler::Handle>("priority_queue (lazy cancel)", w);
+}
+
+int main() {
+    test_ours();
+    bench_timeouts(0.95);
+    bench_timeouts(0.5);
+    return 0;
+}
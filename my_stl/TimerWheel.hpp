@@ -0,0 +1,206 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include "Function.hpp"
+#include "IntrusiveList.hpp"
+#include "Vector.hpp"
+
+// 分层时间轮(同Linux早期的定时器实现): 时间以tick为单位
+// 第0层256个槽, 每槽1个tick; 往上每层64个槽, 每槽是下一层一整圈的长度, 一共覆盖2^26个tick
+// 定时器按到期时间挂在对应层的槽里, 槽是侵入式链表, 插入和取消都是O(1)
+// 第0层转完一圈时, 把上一层当前槽里的定时器重新插入(cascade), 它们会落到更低的层
+// 超出范围的定时器先放在最高层, 每次cascade时重新计算位置
+// 大部分超时在到期前就被取消的场景下, 取消只是从链表摘除, 不像堆那样留下垃圾
+
+struct TimerNode {
+    IntrusiveListHook m_hook;
+    uint64_t m_expire = 0;
+    // 每次节点被回收都加一, 旧的句柄因此失效
+    uint64_t m_generation = 0;
+    Function<void()> m_callback;
+};
+
+// 可以取消的定时器句柄, 定时器触发或取消之后句柄自动失效
+struct TimerHandle {
+    TimerNode *m_node = nullptr;
+    uint64_t m_generation = 0;
+};
+
+struct TimerWheel {
+    using List = IntrusiveList<TimerNode, &TimerNode::m_hook>;
+
+    static constexpr size_t kLevel0Bits = 8;
+    static constexpr size_t kLevelBits = 6;
+    static constexpr size_t kLevels = 4;
+    static constexpr size_t kLevel0Slots = size_t(1) << kLevel0Bits;
+    static constexpr size_t kLevelSlots = size_t(1) << kLevelBits;
+    static constexpr uint64_t kMaxDelay = (uint64_t(1) << (kLevel0Bits + (kLevels - 1) * kLevelBits)) - 1;
+    // 节点按块分配, 块内地址稳定, 回收的节点挂在空闲链表上复用
+    static constexpr size_t kChunkSize = 256;
+
+    List m_level0[kLevel0Slots];
+    List m_levels[kLevels - 1][kLevelSlots];
+    // 到期的定时器先摘到这里, 再逐个触发
+    List m_expired;
+    List m_free;
+    Vector<std::unique_ptr<TimerNode[]>> m_chunks;
+    // 已经处理过的最后一个tick
+    uint64_t m_now = 0;
+    size_t m_count = 0;
+
+    explicit TimerWheel(uint64_t now = 0) noexcept : m_now(now) {}
+
+    TimerWheel(TimerWheel const &) = delete;
+    TimerWheel &operator=(TimerWheel const &) = delete;
+
+    // 节点还挂在各个链表上, 先摘下来再释放块, 避免钩子析构时访问已释放的链表
+    ~TimerWheel() noexcept {
+        for (auto &list: m_level0)
+            list.clear();
+        for (auto &level: m_levels)
+            for (auto &list: level)
+                list.clear();
+        m_expired.clear();
+        m_free.clear();
+    }
+
+    uint64_t now() const noexcept {
+        return m_now;
+    }
+
+    // 还没触发也没取消的定时器个数
+    size_t size() const noexcept {
+        return m_count;
+    }
+
+    bool empty() const noexcept {
+        return m_count == 0;
+    }
+
+    // delay个tick之后触发; delay为0时在下一个tick触发
+    TimerHandle schedule(uint64_t delay, Function<void()> callback) {
+        TimerNode *node = allocate();
+        node->m_expire = m_now + (delay == 0 ? 1 : delay);
+        node->m_callback = std::move(callback);
+        place(node);
+        ++m_count;
+        return TimerHandle{node, node->m_generation};
+    }
+
+    TimerHandle schedule_at(uint64_t expire, Function<void()> callback) {
+        return schedule(expire > m_now ? expire - m_now : 0, std::move(callback));
+    }
+
+    bool pending(TimerHandle handle) const noexcept {
+        return handle.m_node != nullptr && handle.m_node->m_generation == handle.m_generation
+            && handle.m_node->m_hook.is_linked();
+    }
+
+    // 返回是否真的取消了(已经触发或取消过的返回false), O(1)
+    bool cancel(TimerHandle handle) noexcept {
+        if (!pending(handle))
+            return false;
+        TimerNode *node = handle.m_node;
+        node->m_hook.unlink();
+        --m_count;
+        release(node);
+        return true;
+    }
+
+    // 推进到now, 依次处理经过的每个tick, 返回触发的定时器个数
+    // 回调里可以安排新的定时器, 也可以取消其他定时器
+    size_t advance(uint64_t now) {
+        if (m_count == 0) {
+            if (now > m_now)
+                m_now = now;
+            return 0;
+        }
+        while (m_now < now) {
+            ++m_now;
+            size_t idx = m_now & (kLevel0Slots - 1);
+            if (idx == 0)
+                cascade(0);
+            List &slot = m_level0[idx];
+            if (!slot.empty())
+                m_expired.splice_back(slot);
+            if (m_count == 0) {
+                m_now = now;
+                break;
+            }
+        }
+        return fire_expired();
+    }
+
+    size_t tick() {
+        return advance(m_now + 1);
+    }
+
+private:
+    TimerNode *allocate() {
+        if (m_free.empty()) {
+            auto chunk = std::make_unique<TimerNode[]>(kChunkSize);
+            for (size_t i = 0; i < kChunkSize; i++)
+                m_free.push_back(chunk[i]);
+            m_chunks.push_back(std::move(chunk));
+        }
+        return &m_free.pop_front();
+    }
+
+    // 释放回调持有的资源, 节点回到空闲链表
+    void release(TimerNode *node) noexcept {
+        node->m_callback = Function<void()>();
+        ++node->m_generation;
+        m_free.push_front(*node);
+    }
+
+    // 按距离到期还有多少tick选层, 槽号取到期时间在该层的那几位
+    void place(TimerNode *node) noexcept {
+        uint64_t expire = node->m_expire;
+        uint64_t delta = expire - m_now;
+        if (delta < kLevel0Slots) {
+            m_level0[expire & (kLevel0Slots - 1)].push_back(*node);
+            return;
+        }
+        if (delta > kMaxDelay) {
+            // 先放在最高层最远的槽里, cascade时会重新计算
+            expire = m_now + kMaxDelay;
+            delta = kMaxDelay;
+        }
+        for (size_t level = 0; level < kLevels - 1; level++) {
+            size_t shift = kLevel0Bits + level * kLevelBits;
+            if (delta < (uint64_t(1) << (shift + kLevelBits)) || level == kLevels - 2) {
+                m_levels[level][(expire >> shift) & (kLevelSlots - 1)].push_back(*node);
+                return;
+            }
+        }
+    }
+
+    // 把第level层(第0层之上, 从0数)当前槽的定时器重新插入; 本层也转完一圈时先处理再上一层
+    void cascade(size_t level) noexcept {
+        size_t shift = kLevel0Bits + level * kLevelBits;
+        size_t idx = (m_now >> shift) & (kLevelSlots - 1);
+        if (idx == 0 && level + 1 < kLevels - 1)
+            cascade(level + 1);
+        List pending;
+        pending.splice_back(m_levels[level][idx]);
+        while (!pending.empty())
+            place(&pending.pop_front());
+    }
+
+    // 逐个摘下到期的定时器: 先回收节点再调用回调, 回调里拿着的句柄已经失效
+    size_t fire_expired() {
+        size_t fired = 0;
+        while (!m_expired.empty()) {
+            TimerNode &node = m_expired.pop_front();
+            Function<void()> callback = std::move(node.m_callback);
+            --m_count;
+            release(&node);
+            ++fired;
+            if (callback)
+                callback();
+        }
+        return fired;
+    }
+};
@@ -0,0 +1,150 @@
+#include <cstdio>
+#include <list>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Benchmark.hpp"
+#include "List.hpp"
+#include "UnrolledList.hpp"
+
+static_assert(std::bidirectional_iterator<UnrolledList<int>::iterator>);
+static_assert(std::bidirectional_iterator<UnrolledList<int>::const_iterator>);
+
+void test_ours() {
+    UnrolledList<int, 64> arr{1, 2, 3, 4};
+    for (int i = 5; i <= 40; i++)
+        arr.push_back(i);
+    arr.push_front(0);
+    auto it = arr.begin();
+    std::advance(it, 10);
+    it = arr.insert(it, 100);
+    printf("inserted %d, size = %zd, node capacity = %zd\n", *it, arr.size(), arr.kCapacity);
+    for (int i = 0; i < 20; i++)
+        it = arr.erase(it);
+    arr.pop_back();
+    size_t i = 0;
+    arr.foreach([&] (int &val) {
+        printf("arr[%zd] = %d\n", i, val);
+        ++i;
+    });
+    for (auto rit = arr.end(); rit != arr.begin();) {
+        --rit;
+        printf("%d ", *rit);
+    }
+    printf("\n");
+
+    // 参数引用的正是要被平移或分裂搬走的元素
+    UnrolledList<std::string, 128> strs;
+    for (int i = 0; i < 12; i++)
+        strs.push_back("value-" + std::to_string(i));
+    strs.push_front(strs.front());
+    auto mid = strs.begin();
+    std::advance(mid, 5);
+    strs.insert(mid, *mid);
+    mid = strs.begin();
+    std::advance(mid, 3);
+    strs.insert(mid, strs.back());
+    for (auto const &s: strs)
+        printf("%s ", s.c_str());
+    printf("\n");
+
+    // 构造抛异常时链表不变, 不留下析构过的空位
+    struct Fussy {
+        int m_value;
+        Fussy(int value) : m_value(value) {
+            if (value < 0)
+                throw std::runtime_error("negative");
+        }
+    };
+    UnrolledList<Fussy, 64> fussy;
+    for (int i = 0; i < 10; i++)
+        fussy.emplace_back(i);
+    int failures = 0;
+    for (size_t pos: {size_t(0), size_t(3), fussy.size()}) {
+        auto at = fussy.begin();
+        std::advance(at, pos);
+        try {
+            fussy.emplace(at, -1);
+        } catch (std::runtime_error const &) {
+            ++failures;
+        }
+    }
+    int sum = 0;
+    for (auto const &f: fussy)
+        sum += f.m_value;
+    printf("failures = %d, size = %zd, sum = %d\n", failures, fussy.size(), sum);
+}
+
+void bench_traversal(size_t n) {
+    std::vector<int> src(n);
+    std::iota(src.begin(), src.end(), 0);
+    List<int> list(src.begin(), src.end());
+    std::list<int> stdlist(src.begin(), src.end());
+    UnrolledList<int> unrolled(src.begin(), src.end());
+
+    benchmark("List::foreach", [&] {
+        long long sum = 0;
+        list.foreach([&] (int &val) { sum += val; });
+        doNotOptimize(sum);
+    }, n);
+    benchmark("std::list iterate", [&] {
+        long long sum = 0;
+        for (int val: stdlist) sum += val;
+        doNotOptimize(sum);
+    }, n);
+    benchmark("UnrolledList iterate", [&] {
+        long long sum = 0;
+        for (int val: unrolled) sum += val;
+        doNotOptimize(sum);
+    }, n);
+    benchmark("UnrolledList::foreach", [&] {
+        long long sum = 0;
+        unrolled.foreach([&] (int &val) { sum += val; });
+        doNotOptimize(sum);
+    }, n);
+}
+
+// 在随机位置的迭代器处插入, 插入后链表在内存里是乱序的
+template <class L>
+void random_insert(L &l, size_t n) {
+    std::mt19937 rng(42);
+    l.push_back(0);
+    auto it = l.begin();
+    for (size_t i = 1; i < n; i++) {
+        if (rng() % 4 == 0)
+            it = l.begin();
+        else if (it != l.end() && rng() % 2)
+            ++it;
+        it = l.insert(it, (int)i);
+    }
+}
+
+void bench_insert(size_t n) {
+    std::list<int> stdlist;
+    UnrolledList<int> unrolled;
+    benchmark("std::list insert at iterator", [&] {
+        random_insert(stdlist, n);
+    }, n);
+    benchmark("UnrolledList insert at iterator", [&] {
+        random_insert(unrolled, n);
+    }, n);
+    benchmark("std::list iterate after insert", [&] {
+        long long sum = 0;
+        for (int val: stdlist) sum += val;
+        doNotOptimize(sum);
+    }, n);
+    benchmark("UnrolledList iterate after insert", [&] {
+        long long sum = 0;
+        for (int val: unrolled) sum += val;
+        doNotOptimize(sum);
+    }, n);
+}
+
+int main() {
+    test_ours();
+    bench_traversal(1 << 20);
+    bench_insert(1 << 20);
+    return 0;
+}
@@ -0,0 +1,466 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+
+// 展开链表(unrolled linked list): 每个节点存一小段连续数组而不是一个元素
+// List遍历时每个元素一个节点一次cache miss, 这里一次cache miss可以拿到一整个节点的元素
+// NodeBytes是整个节点(含指针)的目标大小, 默认两条cache line
+template <class T, size_t NodeBytes = 128, class Alloc = std::allocator<T>>
+struct UnrolledList {
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using pointer = T *;
+    using const_pointer = T const *;
+    using reference = T &;
+    using const_reference = T const &;
+
+    struct NodeBase {
+        NodeBase *m_next;
+        NodeBase *m_prev;
+        size_t m_count;
+        // 哨兵节点的m_count恒为0
+    };
+
+    static constexpr size_t kCapacity = NodeBytes > sizeof(NodeBase) + 2 * sizeof(T)
+        ? (NodeBytes - sizeof(NodeBase)) / sizeof(T) : 2;
+    // 元素太大时至少放两个, 否则退化成普通链表
+
+    struct Node : NodeBase {
+        union {
+            T m_values[kCapacity];
+        };
+        // 用union避免默认构造kCapacity个T, 只有[0, m_count)是活的
+
+        Node() noexcept {}
+        ~Node() noexcept {}
+    };
+
+    using NodeAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+
+    NodeBase m_dummy;
+    size_t m_size;
+    [[no_unique_address]] NodeAlloc m_alloc;
+
+    UnrolledList() noexcept {
+        m_dummy.m_next = &m_dummy;
+        m_dummy.m_prev = &m_dummy;
+        m_dummy.m_count = 0;
+        m_size = 0;
+    }
+
+    template <std::input_iterator InputIt>
+    UnrolledList(InputIt first, InputIt last) : UnrolledList() {
+        for (; first != last; ++first)
+            push_back(*first);
+    }
+
+    UnrolledList(std::initializer_list<T> ilist)
+    : UnrolledList(ilist.begin(), ilist.end()) {}
+
+    UnrolledList(UnrolledList const &that) : UnrolledList(that.begin(), that.end()) {}
+
+    UnrolledList(UnrolledList &&that) noexcept : UnrolledList() {
+        swap(that);
+    }
+
+    UnrolledList &operator=(UnrolledList const &that) {
+        if (this != &that) [[likely]] {
+            UnrolledList tmp(that);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    UnrolledList &operator=(UnrolledList &&that) noexcept {
+        if (this != &that) [[likely]] {
+            clear();
+            swap(that);
+        }
+        return *this;
+    }
+
+    ~UnrolledList() noexcept {
+        clear();
+    }
+
+    // 接口与List::iterator一致: ++ -- * == !=, 额外记录节点内下标
+    template <bool Const>
+    struct Iterator {
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = ptrdiff_t;
+        using pointer = std::conditional_t<Const, T const *, T *>;
+        using reference = std::conditional_t<Const, T const &, T &>;
+
+        NodeBase *curr = nullptr;
+        size_t idx = 0;
+
+        Iterator() = default;
+        Iterator(NodeBase *node, size_t i) noexcept : curr(node), idx(i) {}
+
+        // iterator可以隐式转为const_iterator
+        template <bool C = Const, class = std::enable_if_t<C>>
+        Iterator(Iterator<false> const &that) noexcept : curr(that.curr), idx(that.idx) {}
+
+        Iterator &operator++() noexcept {
+            if (++idx == curr->m_count) {
+                curr = curr->m_next;
+                idx = 0;
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        Iterator &operator--() noexcept {
+            if (idx == 0) {
+                curr = curr->m_prev;
+                idx = curr->m_count - 1;
+            } else {
+                --idx;
+            }
+            return *this;
+        }
+
+        Iterator operator--(int) noexcept {
+            auto tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        reference operator*() const noexcept {
+            return static_cast<Node *>(curr)->m_values[idx];
+        }
+
+        pointer operator->() const noexcept {
+            return std::addressof(**this);
+        }
+
+        bool operator==(Iterator const &that) const noexcept {
+            return curr == that.curr && idx == that.idx;
+        }
+
+        bool operator!=(Iterator const &that) const noexcept {
+            return !(*this == that);
+        }
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    iterator begin() noexcept {
+        return iterator{m_dummy.m_next, 0};
+    }
+
+    iterator end() noexcept {
+        return iterator{&m_dummy, 0};
+    }
+
+    const_iterator begin() const noexcept {
+        return const_iterator{m_dummy.m_next, 0};
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator{const_cast<NodeBase *>(&m_dummy), 0};
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    size_t size() const noexcept {
+        return m_size;
+    }
+
+    bool empty() const noexcept {
+        return m_size == 0;
+    }
+
+    T &front() noexcept {
+        return node(m_dummy.m_next)->m_values[0];
+    }
+
+    T &back() noexcept {
+        return node(m_dummy.m_prev)->m_values[m_dummy.m_prev->m_count - 1];
+    }
+
+    T const &front() const noexcept {
+        return node(m_dummy.m_next)->m_values[0];
+    }
+
+    T const &back() const noexcept {
+        return node(m_dummy.m_prev)->m_values[m_dummy.m_prev->m_count - 1];
+    }
+
+    // 按节点遍历, 内层循环是连续数组, 编译器可以向量化
+    template <class Visitor>
+    void foreach(Visitor visitor) {
+        for (NodeBase *p = m_dummy.m_next; p != &m_dummy; p = p->m_next) {
+            T *values = node(p)->m_values;
+            for (size_t i = 0; i != p->m_count; i++)
+                visitor(values[i]);
+        }
+    }
+
+    void push_back(T const &val) {
+        emplace(end(), val);
+    }
+
+    void push_back(T &&val) {
+        emplace(end(), std::move(val));
+    }
+
+    void push_front(T const &val) {
+        emplace(begin(), val);
+    }
+
+    void push_front(T &&val) {
+        emplace(begin(), std::move(val));
+    }
+
+    template <class ...Args>
+    T &emplace_back(Args &&...args) {
+        return *emplace(end(), std::forward<Args>(args)...);
+    }
+
+    iterator insert(const_iterator pos, T const &val) {
+        return emplace(pos, val);
+    }
+
+    iterator insert(const_iterator pos, T &&val) {
+        return emplace(pos, std::move(val));
+    }
+
+    // 节点未满时在节点内平移, 满了就对半分裂, 平移量不超过kCapacity, 均摊O(1)
+    // 异常安全: 构造抛异常时链表不变; 平移中元素的移动赋值抛异常时所有位置仍然是活的, m_count和m_size一致
+    template <class ...Args>
+    iterator emplace(const_iterator pos, Args &&...args) {
+        NodeBase *curr = pos.curr;
+        size_t idx = pos.idx;
+        if (curr == &m_dummy) {
+            // 插在末尾: 优先塞进最后一个节点
+            curr = m_dummy.m_prev;
+            if (curr == &m_dummy || curr->m_count == kCapacity)
+                return emplace_new_node(std::forward<Args>(args)...);
+            return emplace_at_end(curr, std::forward<Args>(args)...);
+        }
+        if (idx == 0 && curr->m_prev != &m_dummy && curr->m_prev->m_count < kCapacity) {
+            // 插在节点开头: 前一个节点有空位就追加到它的末尾, 不用平移
+            return emplace_at_end(curr->m_prev, std::forward<Args>(args)...);
+        }
+        // 要平移或分裂已有元素, 而args可能引用其中某个(push_front(front()), insert(pos, *pos))
+        // 先构造到临时对象里, 再搬动已有元素
+        T tmp(std::forward<Args>(args)...);
+        if (curr->m_count == kCapacity) {
+            NodeBase *next = split(curr);
+            if (idx > curr->m_count) {
+                idx -= curr->m_count;
+                curr = next;
+            }
+        }
+        if (idx == curr->m_count)
+            return emplace_at_end(curr, std::move(tmp));
+        shift_right(curr, idx);
+        node(curr)->m_values[idx] = std::move(tmp);
+        return iterator{curr, idx};
+    }
+
+    // 节点少于半满时与后继合并, 保证平均填充率
+    iterator erase(const_iterator pos) noexcept {
+        NodeBase *curr = pos.curr;
+        size_t idx = pos.idx;
+        Node *n = node(curr);
+        std::destroy_at(&n->m_values[idx]);
+        shift_left(n, idx);
+        --curr->m_count;
+        --m_size;
+        if (curr->m_count == 0) {
+            NodeBase *next = curr->m_next;
+            free_node(curr);
+            return iterator{next, 0};
+        }
+        NodeBase *next = curr->m_next;
+        if (curr->m_count < kCapacity / 2 && next != &m_dummy
+            && curr->m_count + next->m_count <= kCapacity) {
+            merge_next(curr);
+        }
+        if (idx == curr->m_count)
+            return iterator{curr->m_next, 0};
+        return iterator{curr, idx};
+    }
+
+    iterator erase(const_iterator first, const_iterator last) noexcept {
+        // 合并可能让last失效, 所以按个数删除
+        size_t n = 0;
+        for (auto it = first; it != last; ++it)
+            ++n;
+        iterator it{first.curr, first.idx};
+        while (n--)
+            it = erase(it);
+        return it;
+    }
+
+    void pop_back() noexcept {
+        erase(--end());
+    }
+
+    void pop_front() noexcept {
+        erase(begin());
+    }
+
+    void clear() noexcept {
+        NodeBase *p = m_dummy.m_next;
+        while (p != &m_dummy) {
+            NodeBase *next = p->m_next;
+            Node *n = node(p);
+            std::destroy(n->m_values, n->m_values + p->m_count);
+            std::destroy_at(n);
+            m_alloc.deallocate(n, 1);
+            p = next;
+        }
+        m_dummy.m_next = &m_dummy;
+        m_dummy.m_prev = &m_dummy;
+        m_size = 0;
+    }
+
+    void swap(UnrolledList &that) noexcept {
+        bool this_empty = empty();
+        bool that_empty = that.empty();
+        std::swap(m_dummy.m_next, that.m_dummy.m_next);
+        std::swap(m_dummy.m_prev, that.m_dummy.m_prev);
+        std::swap(m_size, that.m_size);
+        relink_dummy(that_empty);
+        that.relink_dummy(this_empty);
+    }
+
+private:
+    static Node *node(NodeBase *p) noexcept {
+        return static_cast<Node *>(p);
+    }
+
+    static Node const *node(NodeBase const *p) noexcept {
+        return static_cast<Node const *>(p);
+    }
+
+    void relink_dummy(bool was_empty) noexcept {
+        if (was_empty) {
+            m_dummy.m_next = m_dummy.m_prev = &m_dummy;
+        } else {
+            m_dummy.m_next->m_prev = &m_dummy;
+            m_dummy.m_prev->m_next = &m_dummy;
+        }
+    }
+
+    NodeBase *new_node_before(NodeBase *pos) {
+        Node *n = m_alloc.allocate(1);
+        std::construct_at(n);
+        n->m_count = 0;
+        n->m_next = pos;
+        n->m_prev = pos->m_prev;
+        pos->m_prev->m_next = n;
+        pos->m_prev = n;
+        return n;
+    }
+
+    void free_node(NodeBase *p) noexcept {
+        p->m_prev->m_next = p->m_next;
+        p->m_next->m_prev = p->m_prev;
+        Node *n = node(p);
+        std::destroy_at(n);
+        m_alloc.deallocate(n, 1);
+    }
+
+    // 直接构造在节点末尾的空位上, 不搬动已有元素
+    template <class ...Args>
+    iterator emplace_at_end(NodeBase *curr, Args &&...args) {
+        size_t idx = curr->m_count;
+        std::construct_at(&node(curr)->m_values[idx], std::forward<Args>(args)...);
+        ++curr->m_count;
+        ++m_size;
+        return iterator{curr, idx};
+    }
+
+    // 末尾新开一个节点; 构造抛异常时把空节点摘掉, 链表里不留m_count为0的节点
+    template <class ...Args>
+    iterator emplace_new_node(Args &&...args) {
+        NodeBase *curr = new_node_before(&m_dummy);
+        try {
+            return emplace_at_end(curr, std::forward<Args>(args)...);
+        } catch (...) {
+            free_node(curr);
+            throw;
+        }
+    }
+
+    // 把满节点的后一半搬到新节点, 返回新节点
+    NodeBase *split(NodeBase *curr) {
+        NodeBase *next = new_node_before(curr->m_next);
+        size_t half = curr->m_count / 2;
+        size_t count = curr->m_count;
+        Node *src = node(curr);
+        Node *dst = node(next);
+        // 全部搬完再析构旧的, 中途移动构造抛异常时原节点还是完整的
+        size_t i = half;
+        try {
+            for (; i != count; i++)
+                std::construct_at(&dst->m_values[i - half], std::move(src->m_values[i]));
+        } catch (...) {
+            std::destroy(dst->m_values, dst->m_values + (i - half));
+            free_node(next);
+            throw;
+        }
+        std::destroy(src->m_values + half, src->m_values + count);
+        next->m_count = count - half;
+        curr->m_count = half;
+        return next;
+    }
+
+    void merge_next(NodeBase *curr) noexcept {
+        NodeBase *next = curr->m_next;
+        Node *dst = node(curr);
+        Node *src = node(next);
+        for (size_t i = 0; i != next->m_count; i++) {
+            std::construct_at(&dst->m_values[curr->m_count + i], std::move(src->m_values[i]));
+            std::destroy_at(&src->m_values[i]);
+        }
+        curr->m_count += next->m_count;
+        next->m_count = 0;
+        free_node(next);
+    }
+
+    // [idx, count) 整体右移一格: 末尾多出的位置先构造出来并计入大小, idx处留下一个被move走的元素, 由调用者赋值
+    void shift_right(NodeBase *curr, size_t idx) {
+        Node *n = node(curr);
+        size_t count = curr->m_count;
+        std::construct_at(&n->m_values[count], std::move(n->m_values[count - 1]));
+        ++curr->m_count;
+        ++m_size;
+        std::move_backward(n->m_values + idx, n->m_values + count - 1, n->m_values + count);
+    }
+
+    // idx处已析构, [idx + 1, count) 整体左移一格
+    static void shift_left(Node *n, size_t idx) noexcept {
+        size_t count = n->m_count;
+        if (idx + 1 == count)
+            return;
+        std::construct_at(&n->m_values[idx], std::move(n->m_values[idx + 1]));
+        std::move(n->m_values + idx + 2, n->m_values + count, n->m_values + idx + 1);
+        std::destroy_at(&n->m_values[count - 1]);
+    }
+};
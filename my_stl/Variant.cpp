@@ -0,0 +1,165 @@
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <variant>
+#include <vector>
+#include "Benchmark.hpp"
+#include "Variant.hpp"
+
+// 模拟消息分派: 几种小消息
+struct Ping { uint32_t m_seq; };
+struct Data { uint32_t m_len; uint32_t m_crc; };
+struct Ack { uint32_t m_seq; };
+struct Close { uint8_t m_reason; };
+
+using Message = Variant<Ping, Data, Ack, Close>;
+using StdMessage = std::variant<Ping, Data, Ack, Close>;
+
+static_assert(std::is_trivially_copyable_v<Message>);
+static_assert(std::is_trivially_destructible_v<Message>);
+static_assert(!std::is_trivially_copyable_v<Variant<int, std::string>>);
+static_assert(sizeof(Variant<char, bool>) == 2);
+static_assert(sizeof(Message::index_type) == 1);
+
+void test_ours() {
+    Variant<int, double, std::string> v = std::string("hello");
+    auto print = Overloaded{
+        [] (int x) { printf("int %d\n", x); },
+        [] (double x) { printf("double %g\n", x); },
+        [] (std::string const &s) { printf("string %s\n", s.c_str()); },
+    };
+    visit(print, v);
+    v = 3.5;
+    visit(print, v);
+    v = 42;
+    visit(print, v);
+    printf("index = %zd, holds int: %d, get_if<double> == nullptr: %d\n",
+           v.index(), v.holds_alternative<int>(), get_if<double>(&v) == nullptr);
+    try {
+        get<std::string>(v);
+    } catch (BadVariantAccess const &e) {
+        printf("get<string>: %s\n", e.what());
+    }
+    Variant<int, double, std::string> w = v;
+    w.emplace<std::string>(3, 'x');
+    v.swap(w);
+    printf("after swap: v = %s, w = %d, v == w: %d\n", get<2>(v).c_str(), get<int>(w), v == w);
+
+    // 多个Variant一起分派, 走函数指针表
+    Variant<int, double> a = 2, b = 0.5;
+    double r = visit([] (auto x, auto y) { return (double)x * y; }, a, b);
+    printf("multi-visit: %g\n", r);
+}
+
+template <class Msg>
+std::vector<Msg> make_messages(size_t n) {
+    std::mt19937 rng(42);
+    std::vector<Msg> msgs;
+    msgs.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        switch (rng() % 4) {
+        case 0: msgs.emplace_back(Ping{(uint32_t)i}); break;
+        case 1: msgs.emplace_back(Data{(uint32_t)i & 0xfff, (uint32_t)rng()}); break;
+        case 2: msgs.emplace_back(Ack{(uint32_t)i}); break;
+        default: msgs.emplace_back(Close{(uint8_t)i}); break;
+        }
+    }
+    return msgs;
+}
+
+struct Handler {
+    uint64_t m_sum = 0;
+
+    void operator()(Ping const &m) { m_sum += m.m_seq; }
+    void operator()(Data const &m) { m_sum += m.m_len ^ m.m_crc; }
+    void operator()(Ack const &m) { m_sum -= m.m_seq; }
+    void operator()(Close const &m) { m_sum += m.m_reason * 3; }
+};
+
+void bench_dispatch(size_t n) {
+    printf("== dispatch %zd messages, sizeof(Variant) = %zd, sizeof(std::variant) = %zd ==\n",
+           n, sizeof(Message), sizeof(StdMessage));
+    auto msgs = make_messages<Message>(n);
+    auto std_msgs = make_messages<StdMessage>(n);
+    benchmark("Variant visit", [&] {
+        Handler h;
+        for (auto const &m: msgs)
+            visit(h, m);
+        doNotOptimize(h.m_sum);
+    }, n);
+    benchmark("std::variant std::visit", [&] {
+        Handler h;
+        for (auto const &m: std_msgs)
+            std::visit(h, m);
+        doNotOptimize(h.m_sum);
+    }, n);
+}
+
+// 超过16个alternative时单个visit也走函数指针表
+template <int I>
+struct Tag { uint32_t m_value; };
+
+template <class V, size_t ...Is>
+std::vector<V> make_tags(size_t n, std::index_sequence<Is...>) {
+    std::mt19937 rng(7);
+    using Maker = V (*)(uint32_t);
+    Maker makers[] = {[] (uint32_t x) { return V(Tag<(int)Is>{x}); }...};
+    std::vector<V> out;
+    out.reserve(n);
+    for (size_t i = 0; i < n; i++)
+        out.push_back(makers[rng() % sizeof...(Is)]((uint32_t)i));
+    return out;
+}
+
+template <size_t ...Is>
+void bench_wide(size_t n, std::index_sequence<Is...> seq) {
+    using Wide = Variant<Tag<(int)Is>...>;
+    using StdWide = std::variant<Tag<(int)Is>...>;
+    printf("== dispatch %zd messages over %zd alternatives ==\n", n, sizeof...(Is));
+    auto msgs = make_tags<Wide>(n, seq);
+    auto std_msgs = make_tags<StdWide>(n, seq);
+    auto f = [] (auto const &t) { return t.m_value * 2654435761u; };
+    benchmark("Variant visit (table)", [&] {
+        uint64_t sum = 0;
+        for (auto const &m: msgs)
+            sum += visit(f, m);
+        doNotOptimize(sum);
+    }, n);
+    benchmark("std::variant std::visit", [&] {
+        uint64_t sum = 0;
+        for (auto const &m: std_msgs)
+            sum += std::visit(f, m);
+        doNotOptimize(sum);
+    }, n);
+}
+
+void bench_multi(size_t n) {
+    printf("== double dispatch %zd pairs ==\n", n);
+    auto a = make_messages<Message>(n);
+    auto b = make_messages<Message>(n + 1);
+    auto sa = make_messages<StdMessage>(n);
+    auto sb = make_messages<StdMessage>(n + 1);
+    auto f = [] (auto const &x, auto const &y) { return sizeof(x) * 3 + sizeof(y); };
+    benchmark("Variant visit(f, a, b)", [&] {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < n; i++)
+            sum += visit(f, a[i], b[i + 1]);
+        doNotOptimize(sum);
+    }, n);
+    benchmark("std::visit(f, a, b)", [&] {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < n; i++)
+            sum += std::visit(f, sa[i], sb[i + 1]);
+        doNotOptimize(sum);
+    }, n);
+}
+
+int main() {
+    test_ours();
+    size_t n = 1 << 22;
+    bench_dispatch(n);
+    bench_wide(n, std::make_index_sequence<24>{});
+    bench_multi(n);
+    return 0;
+}
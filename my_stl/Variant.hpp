@@ -0,0 +1,444 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+struct BadVariantAccess : std::exception {
+    BadVariantAccess() = default;
+    virtual ~BadVariantAccess() = default;
+
+    const char *what() const noexcept override {
+        return "bad variant access";
+    }
+};
+
+#if defined (_MSC_VER)
+#define MYSTL_VARIANT_UNREACHABLE() __assume(0)
+#elif defined (__GNUC__)
+#define MYSTL_VARIANT_UNREACHABLE() __builtin_unreachable()
+#else
+#define MYSTL_VARIANT_UNREACHABLE() std::terminate()
+#endif
+
+// 把多个lambda合成一个重载集合, 配合visit使用
+template <class ...Fs>
+struct Overloaded : Fs... {
+    using Fs::operator()...;
+};
+
+template <class ...Fs>
+Overloaded(Fs...) -> Overloaded<Fs...>;
+
+template <class ...Ts>
+struct Variant;
+
+template <class V>
+struct VariantSize;
+
+template <class ...Ts>
+struct VariantSize<Variant<Ts...>> : std::integral_constant<size_t, sizeof...(Ts)> {};
+
+template <class V>
+inline constexpr size_t VariantSize_v = VariantSize<std::remove_cvref_t<V>>::value;
+
+namespace variant_detail {
+
+template <size_t I, class ...Ts>
+using TypeAt = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+// T在Ts中第一次出现的位置, 没有时为sizeof...(Ts)
+template <class T, class ...Ts>
+constexpr size_t index_of() {
+    constexpr bool same[] = {std::is_same_v<T, Ts>..., false};
+    for (size_t i = 0; i != sizeof...(Ts); i++) {
+        if (same[i])
+            return i;
+    }
+    return sizeof...(Ts);
+}
+
+template <class T, class ...Ts>
+constexpr size_t count_of() {
+    return (0 + ... + (size_t)std::is_same_v<T, Ts>);
+}
+
+// 从U构造时选哪个alternative: 有完全相同的类型就选它, 否则要求恰好一个类型能从U构造
+template <class U, class ...Ts>
+constexpr size_t select_index() {
+    using D = std::remove_cvref_t<U>;
+    if constexpr (count_of<D, Ts...>() != 0) {
+        return index_of<D, Ts...>();
+    } else {
+        constexpr bool ok[] = {std::is_constructible_v<Ts, U>..., false};
+        size_t found = sizeof...(Ts);
+        for (size_t i = 0; i != sizeof...(Ts); i++) {
+            if (ok[i])
+                found = found == sizeof...(Ts) ? i : sizeof...(Ts) + 1;
+        }
+        return found;
+    }
+}
+
+// 能放下0..N(N表示valueless)的最小无符号类型
+template <size_t N>
+using IndexType = std::conditional_t<(N < UINT8_MAX), uint8_t,
+                  std::conditional_t<(N < UINT16_MAX), uint16_t, uint32_t>>;
+
+} // namespace variant_detail
+
+// 带标签的union: 存储是一块按最大alternative对齐的字节数组, 后面跟一个尽量小的下标
+// 所有alternative都平凡时, 拷贝/移动/析构也都平凡(同Optional, 用requires约束的=default)
+// 赋值成不同类型时先析构再构造, 构造抛异常后进入valueless状态
+template <class ...Ts>
+struct Variant {
+    static_assert(sizeof...(Ts) != 0, "Variant needs at least one alternative");
+    static_assert((!std::is_reference_v<Ts> && ...), "Variant does not store references");
+
+    using index_type = variant_detail::IndexType<sizeof...(Ts)>;
+    static constexpr size_t npos = sizeof...(Ts);
+
+    template <size_t I>
+    using Alternative = variant_detail::TypeAt<I, Ts...>;
+
+    Variant() noexcept(std::is_nothrow_default_constructible_v<Alternative<0>>)
+    requires std::is_default_constructible_v<Alternative<0>> : m_index(0) {
+        ::new (m_storage) Alternative<0>();
+    }
+
+    template <class U, size_t I = variant_detail::select_index<U, Ts...>()>
+    requires (!std::is_same_v<std::remove_cvref_t<U>, Variant>) && (I < sizeof...(Ts))
+    Variant(U &&value) noexcept(std::is_nothrow_constructible_v<Alternative<I>, U>) : m_index((index_type)I) {
+        ::new (m_storage) Alternative<I>(std::forward<U>(value));
+    }
+
+    template <size_t I, class ...Args>
+    explicit Variant(std::in_place_index_t<I>, Args &&...args) : m_index((index_type)I) {
+        ::new (m_storage) Alternative<I>(std::forward<Args>(args)...);
+    }
+
+    template <class T, class ...Args>
+    explicit Variant(std::in_place_type_t<T>, Args &&...args)
+    : Variant(std::in_place_index<variant_detail::index_of<T, Ts...>()>, std::forward<Args>(args)...) {}
+
+    Variant(Variant const &) requires (std::is_trivially_copy_constructible_v<Ts> && ...) = default;
+
+    Variant(Variant const &other) : m_index((index_type)npos) {
+        other.visit_indexed([&] <size_t I> (std::integral_constant<size_t, I>, auto const &value) {
+            ::new (m_storage) Alternative<I>(value);
+        });
+        m_index = other.m_index;
+    }
+
+    Variant(Variant &&) requires (std::is_trivially_move_constructible_v<Ts> && ...) = default;
+
+    Variant(Variant &&other) noexcept((std::is_nothrow_move_constructible_v<Ts> && ...)) : m_index((index_type)npos) {
+        std::move(other).visit_indexed([&] <size_t I> (std::integral_constant<size_t, I>, auto &&value) {
+            ::new (m_storage) Alternative<I>(std::move(value));
+        });
+        m_index = other.m_index;
+    }
+
+    Variant &operator=(Variant const &) requires (std::is_trivially_copyable_v<Ts> && ...) = default;
+
+    Variant &operator=(Variant const &other) {
+        if (this == &other)
+            return *this;
+        if (other.m_index == npos) {
+            reset();
+        } else if (m_index == other.m_index) {
+            other.visit_indexed([&] <size_t I> (std::integral_constant<size_t, I>, auto const &value) {
+                get_unchecked<I>() = value;
+            });
+        } else {
+            other.visit_indexed([&] <size_t I> (std::integral_constant<size_t, I>, auto const &value) {
+                emplace<I>(value);
+            });
+        }
+        return *this;
+    }
+
+    Variant &operator=(Variant &&) requires (std::is_trivially_copyable_v<Ts> && ...) = default;
+
+    Variant &operator=(Variant &&other) noexcept((std::is_nothrow_move_constructible_v<Ts> && ...)
+                                                 && (std::is_nothrow_move_assignable_v<Ts> && ...)) {
+        if (this == &other)
+            return *this;
+        if (other.m_index == npos) {
+            reset();
+        } else if (m_index == other.m_index) {
+            std::move(other).visit_indexed([&] <size_t I> (std::integral_constant<size_t, I>, auto &&value) {
+                get_unchecked<I>() = std::move(value);
+            });
+        } else {
+            std::move(other).visit_indexed([&] <size_t I> (std::integral_constant<size_t, I>, auto &&value) {
+                emplace<I>(std::move(value));
+            });
+        }
+        return *this;
+    }
+
+    template <class U, size_t I = variant_detail::select_index<U, Ts...>()>
+    requires (!std::is_same_v<std::remove_cvref_t<U>, Variant>) && (I < sizeof...(Ts))
+    Variant &operator=(U &&value) {
+        if (m_index == I)
+            get_unchecked<I>() = std::forward<U>(value);
+        else
+            emplace<I>(std::forward<U>(value));
+        return *this;
+    }
+
+    ~Variant() requires (std::is_trivially_destructible_v<Ts> && ...) = default;
+
+    ~Variant() noexcept {
+        reset();
+    }
+
+    constexpr size_t index() const noexcept {
+        return m_index;
+    }
+
+    constexpr bool valueless_by_exception() const noexcept {
+        return m_index == npos;
+    }
+
+    template <size_t I, class ...Args>
+    Alternative<I> &emplace(Args &&...args) {
+        reset();
+        ::new (m_storage) Alternative<I>(std::forward<Args>(args)...);
+        m_index = (index_type)I;
+        return get_unchecked<I>();
+    }
+
+    template <class T, class ...Args>
+    T &emplace(Args &&...args) {
+        return emplace<variant_detail::index_of<T, Ts...>()>(std::forward<Args>(args)...);
+    }
+
+    template <class T>
+    bool holds_alternative() const noexcept {
+        static_assert(variant_detail::count_of<T, Ts...>() == 1, "T must occur exactly once in Ts");
+        return m_index == variant_detail::index_of<T, Ts...>();
+    }
+
+    // 不检查下标, 调用者保证index() == I
+    template <size_t I>
+    Alternative<I> &get_unchecked() noexcept {
+        return *std::launder(reinterpret_cast<Alternative<I> *>(m_storage));
+    }
+
+    template <size_t I>
+    Alternative<I> const &get_unchecked() const noexcept {
+        return *std::launder(reinterpret_cast<Alternative<I> const *>(m_storage));
+    }
+
+    void swap(Variant &other) {
+        Variant tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    bool operator==(Variant const &other) const {
+        if (m_index != other.m_index)
+            return false;
+        if (m_index == npos)
+            return true;
+        bool equal = false;
+        visit_indexed([&] <size_t I> (std::integral_constant<size_t, I>, auto const &value) {
+            equal = value == other.template get_unchecked<I>();
+        });
+        return equal;
+    }
+
+private:
+    void reset() noexcept {
+        if constexpr (!(std::is_trivially_destructible_v<Ts> && ...)) {
+            if (m_index != npos) {
+                visit_indexed([] <size_t I> (std::integral_constant<size_t, I>, auto &value) {
+                    std::destroy_at(&value);
+                });
+            }
+        }
+        m_index = (index_type)npos;
+    }
+
+    // 内部用的分派: f同时拿到编译期下标和值, 跳过valueless
+    template <class F>
+    void visit_indexed(F &&f) & {
+        visit_indexed_impl(*this, f);
+    }
+
+    template <class F>
+    void visit_indexed(F &&f) const & {
+        visit_indexed_impl(*this, f);
+    }
+
+    template <class F>
+    void visit_indexed(F &&f) && {
+        visit_indexed_impl(std::move(*this), f);
+    }
+
+    template <class Self, class F, size_t ...Is>
+    static void visit_indexed_impl(Self &&self, F &f, std::index_sequence<Is...>) {
+        // 折叠表达式里的短路或: 编译器会把它合成一个switch
+        (void)((self.m_index == Is
+                && (f(std::integral_constant<size_t, Is>{},
+                      std::forward<Self>(self).template get_unchecked<Is>()), true)) || ...);
+    }
+
+    template <class Self, class F>
+    static void visit_indexed_impl(Self &&self, F &f) {
+        visit_indexed_impl(std::forward<Self>(self), f, std::index_sequence_for<Ts...>{});
+    }
+
+    alignas(Ts...) unsigned char m_storage[std::max({sizeof(Ts)...})];
+    index_type m_index;
+};
+
+template <size_t I, class ...Ts>
+auto &get(Variant<Ts...> &v) {
+    if (v.index() != I)
+        throw BadVariantAccess();
+    return v.template get_unchecked<I>();
+}
+
+template <size_t I, class ...Ts>
+auto const &get(Variant<Ts...> const &v) {
+    if (v.index() != I)
+        throw BadVariantAccess();
+    return v.template get_unchecked<I>();
+}
+
+template <size_t I, class ...Ts>
+auto &&get(Variant<Ts...> &&v) {
+    if (v.index() != I)
+        throw BadVariantAccess();
+    return std::move(v.template get_unchecked<I>());
+}
+
+template <class T, class ...Ts>
+T &get(Variant<Ts...> &v) {
+    return get<variant_detail::index_of<T, Ts...>()>(v);
+}
+
+template <class T, class ...Ts>
+T const &get(Variant<Ts...> const &v) {
+    return get<variant_detail::index_of<T, Ts...>()>(v);
+}
+
+template <size_t I, class ...Ts>
+auto *get_if(Variant<Ts...> *v) noexcept {
+    return v != nullptr && v->index() == I ? &v->template get_unchecked<I>() : nullptr;
+}
+
+template <class T, class ...Ts>
+T *get_if(Variant<Ts...> *v) noexcept {
+    return get_if<variant_detail::index_of<T, Ts...>()>(v);
+}
+
+namespace variant_detail {
+
+// 按值类别转发Variant里的第I个alternative
+template <size_t I, class V>
+decltype(auto) forward_alt(V &&v) noexcept {
+    if constexpr (std::is_lvalue_reference_v<V>)
+        return v.template get_unchecked<I>();
+    else
+        return std::move(v.template get_unchecked<I>());
+}
+
+template <class F, class ...Vs>
+using VisitResult = std::invoke_result_t<F, decltype(forward_alt<0>(std::declval<Vs>()))...>;
+
+// 函数指针表: 把多个下标展平成一个, table[i0 * M1 * M2 + i1 * M2 + i2], Mi = Ni + 1
+// 每一维多留一格给valueless(下标为Ni), 对应的表项抛异常, 分派时就不用再单独判断
+template <class R, class F, class ...Vs>
+struct VisitTable {
+    static constexpr size_t kSizes[] = {VariantSize_v<Vs> + 1 ...};
+    static constexpr size_t kTotal = ((VariantSize_v<Vs> + 1) * ...);
+
+    // 展平下标K在第J个Variant上对应的下标
+    static constexpr size_t digit(size_t k, size_t j) noexcept {
+        for (size_t i = sizeof...(Vs) - 1; i > j; i--)
+            k /= kSizes[i];
+        return k % kSizes[j];
+    }
+
+    template <size_t K, size_t ...J>
+    static R call_impl(std::index_sequence<J...>, F &&f, Vs &&...vs) {
+        if constexpr (((digit(K, J) == VariantSize_v<Vs>) || ...))
+            throw BadVariantAccess();
+        else
+            return std::invoke(std::forward<F>(f), forward_alt<digit(K, J)>(std::forward<Vs>(vs))...);
+    }
+
+    template <size_t K>
+    static R call(F &&f, Vs &&...vs) {
+        return call_impl<K>(std::index_sequence_for<Vs...>{}, std::forward<F>(f), std::forward<Vs>(vs)...);
+    }
+
+    using Fn = R (*)(F &&, Vs &&...);
+
+    template <size_t ...K>
+    static constexpr auto make(std::index_sequence<K...>) noexcept {
+        return std::array<Fn, kTotal>{&call<K>...};
+    }
+
+    static constexpr auto kTable = make(std::make_index_sequence<kTotal>{});
+
+    static size_t flat_index(Vs const &...vs) noexcept {
+        size_t k = 0;
+        ((k = k * (VariantSize_v<Vs> + 1) + vs.index()), ...);
+        return k;
+    }
+};
+
+// 单个Variant且alternative不多时用switch, 编译器生成一张跳转表, 分支可以内联
+// 超出kSwitchCases个的用函数指针表
+inline constexpr size_t kSwitchCases = 16;
+
+#define MYSTL_VARIANT_CASE(I) \
+    case I: \
+        if constexpr (I < N) \
+            return std::invoke(std::forward<F>(f), forward_alt<I>(std::forward<V>(v))); \
+        else if constexpr (I == N) \
+            throw BadVariantAccess(); \
+        else \
+            MYSTL_VARIANT_UNREACHABLE();
+
+template <class R, class F, class V>
+R visit_switch(F &&f, V &&v) {
+    constexpr size_t N = VariantSize_v<V>;
+    switch (v.index()) {
+    MYSTL_VARIANT_CASE(0) MYSTL_VARIANT_CASE(1) MYSTL_VARIANT_CASE(2) MYSTL_VARIANT_CASE(3)
+    MYSTL_VARIANT_CASE(4) MYSTL_VARIANT_CASE(5) MYSTL_VARIANT_CASE(6) MYSTL_VARIANT_CASE(7)
+    MYSTL_VARIANT_CASE(8) MYSTL_VARIANT_CASE(9) MYSTL_VARIANT_CASE(10) MYSTL_VARIANT_CASE(11)
+    MYSTL_VARIANT_CASE(12) MYSTL_VARIANT_CASE(13) MYSTL_VARIANT_CASE(14) MYSTL_VARIANT_CASE(15)
+    default:
+        // 只有N == kSwitchCases时的valueless会走到这里
+        throw BadVariantAccess();
+    }
+}
+
+#undef MYSTL_VARIANT_CASE
+
+} // namespace variant_detail
+
+// 对一个或多个Variant分派: f要能接受所有alternative的组合, 且返回类型一致
+template <class F, class ...Vs>
+decltype(auto) visit(F &&f, Vs &&...vs) {
+    using R = variant_detail::VisitResult<F, Vs...>;
+    if constexpr (sizeof...(Vs) == 1 && (VariantSize_v<Vs> * ...) <= variant_detail::kSwitchCases) {
+        return variant_detail::visit_switch<R>(std::forward<F>(f), std::forward<Vs>(vs)...);
+    } else {
+        using Table = variant_detail::VisitTable<R, F, Vs...>;
+        return Table::kTable[Table::flat_index(vs...)](std::forward<F>(f), std::forward<Vs>(vs)...);
+    }
+}